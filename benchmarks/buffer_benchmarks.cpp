@@ -0,0 +1,261 @@
+#include "lib/CCircularBuffer.h"
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+struct Pod64 {
+    int64_t key;
+    char payload[56];
+
+    bool operator<(const Pod64& rhs) const {
+        return key < rhs.key;
+    }
+};
+
+static uint64_t scramble(uint64_t i) {
+    return (i * 0x9E3779B97F4A7C15ull) >> 17;
+}
+
+template<typename T>
+static T make_value(uint64_t i);
+
+template<>
+int make_value<int>(uint64_t i) {
+    return static_cast<int>(scramble(i));
+}
+
+template<>
+Pod64 make_value<Pod64>(uint64_t i) {
+    Pod64 value{};
+    value.key = static_cast<int64_t>(scramble(i));
+
+    return value;
+}
+
+template<>
+std::string make_value<std::string>(uint64_t i) {
+    return "value-" + std::to_string(scramble(i));
+}
+
+static int64_t key_of(int value) {
+    return value;
+}
+
+static int64_t key_of(const Pod64& value) {
+    return value.key;
+}
+
+static int64_t key_of(const std::string& value) {
+    return static_cast<int64_t>(value.size());
+}
+
+template<class Container>
+struct BenchContainer {
+    static Container make(size_t capacity) {
+        return Container(capacity);
+    }
+
+    static void pop_front(Container& container) {
+        benchmark::DoNotOptimize(container.pop_front());
+    }
+
+    static void insert_erase(Container& container, size_t idx, const typename Container::value_type& value) {
+        container.insert(value, container.begin() + idx);
+        container.erase(idx);
+    }
+};
+
+template<typename T>
+struct BenchContainer<std::deque<T>> {
+    static std::deque<T> make(size_t) {
+        return std::deque<T>();
+    }
+
+    static void pop_front(std::deque<T>& container) {
+        benchmark::DoNotOptimize(container.front());
+        container.pop_front();
+    }
+
+    static void insert_erase(std::deque<T>& container, size_t idx, const T& value) {
+        container.insert(container.begin() + idx, value);
+        container.erase(container.begin() + idx);
+    }
+};
+
+template<typename T>
+struct BenchContainer<std::vector<T>> {
+    static std::vector<T> make(size_t capacity) {
+        std::vector<T> container;
+        container.reserve(capacity);
+
+        return container;
+    }
+
+    static void insert_erase(std::vector<T>& container, size_t idx, const T& value) {
+        container.insert(container.begin() + idx, value);
+        container.erase(container.begin() + idx);
+    }
+};
+
+template<class Container>
+static Container make_filled(size_t count) {
+    typedef typename Container::value_type T;
+    Container container = BenchContainer<Container>::make(count);
+    for (size_t i = 0; i < count; ++i) {
+        container.push_back(make_value<T>(i));
+    }
+
+    return container;
+}
+
+static void Capacities(benchmark::internal::Benchmark* benchmark_) {
+    benchmark_->RangeMultiplier(16)->Range(16, 16 << 20);
+}
+
+template<class Container>
+static void BM_PushBackPopFront(benchmark::State& state) {
+    typedef typename Container::value_type T;
+    size_t count = state.range(0);
+    Container container = make_filled<Container>(count - 1);
+    T value = make_value<T>(count);
+
+    for (auto _ : state) {
+        container.push_back(value);
+        BenchContainer<Container>::pop_front(container);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<class Container>
+static void BM_OverwritePushBack(benchmark::State& state) {
+    typedef typename Container::value_type T;
+    Container container = make_filled<Container>(state.range(0));
+    T value = make_value<T>(0);
+
+    for (auto _ : state) {
+        container.push_back(value);
+    }
+    benchmark::DoNotOptimize(container.front());
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<class Container>
+static void BM_Iterate(benchmark::State& state) {
+    Container container = make_filled<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto i = container.begin(); i != container.end(); ++i) {
+            sum += key_of(*i);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Container>
+static void BM_RandomAccess(benchmark::State& state) {
+    size_t count = state.range(0);
+    Container container = make_filled<Container>(count);
+    std::vector<size_t> indices(4096);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = scramble(i) % count;
+    }
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (size_t idx : indices) {
+            sum += key_of(container[idx]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * indices.size());
+}
+
+template<class Container>
+static void BM_Sort(benchmark::State& state) {
+    typedef typename Container::value_type T;
+    size_t count = state.range(0);
+    Container container = make_filled<Container>(count);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        size_t n = 0;
+        for (auto i = container.begin(); i != container.end(); ++i, ++n) {
+            *i = make_value<T>(n);
+        }
+        state.ResumeTiming();
+
+        std::sort(container.begin(), container.end());
+        benchmark::DoNotOptimize(container[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+template<class Container>
+static void BM_InsertEraseMiddle(benchmark::State& state) {
+    typedef typename Container::value_type T;
+    size_t count = state.range(0);
+    Container container = make_filled<Container>(count);
+    T value = make_value<T>(count);
+
+    for (auto _ : state) {
+        BenchContainer<Container>::insert_erase(container, count / 2, value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<class Container>
+static void BM_GrowFromEmpty(benchmark::State& state) {
+    typedef typename Container::value_type T;
+    size_t count = state.range(0);
+    T value = make_value<T>(0);
+
+    for (auto _ : state) {
+        Container container;
+        for (size_t i = 0; i < count; ++i) {
+            container.push_back(value);
+        }
+        benchmark::DoNotOptimize(container.back());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+#define BENCHMARK_ALL_TYPES(name, container, apply)                 \
+    BENCHMARK_TEMPLATE(name, container<int>)->Apply(apply);         \
+    BENCHMARK_TEMPLATE(name, container<Pod64>)->Apply(apply);       \
+    BENCHMARK_TEMPLATE(name, container<std::string>)->Apply(apply)
+
+BENCHMARK_ALL_TYPES(BM_PushBackPopFront, CCircularBuffer, Capacities);
+BENCHMARK_ALL_TYPES(BM_PushBackPopFront, CCircularBufferPow2, Capacities);
+BENCHMARK_ALL_TYPES(BM_PushBackPopFront, CCircularBufferExt, Capacities);
+BENCHMARK_ALL_TYPES(BM_PushBackPopFront, std::deque, Capacities);
+
+BENCHMARK_ALL_TYPES(BM_OverwritePushBack, CCircularBuffer, Capacities);
+BENCHMARK_ALL_TYPES(BM_OverwritePushBack, CCircularBufferPow2, Capacities);
+
+BENCHMARK_ALL_TYPES(BM_Iterate, CCircularBuffer, Capacities);
+BENCHMARK_ALL_TYPES(BM_Iterate, CCircularBufferPow2, Capacities);
+BENCHMARK_ALL_TYPES(BM_Iterate, std::deque, Capacities);
+BENCHMARK_ALL_TYPES(BM_Iterate, std::vector, Capacities);
+
+BENCHMARK_ALL_TYPES(BM_RandomAccess, CCircularBuffer, Capacities);
+BENCHMARK_ALL_TYPES(BM_RandomAccess, CCircularBufferPow2, Capacities);
+BENCHMARK_ALL_TYPES(BM_RandomAccess, std::deque, Capacities);
+BENCHMARK_ALL_TYPES(BM_RandomAccess, std::vector, Capacities);
+
+BENCHMARK_ALL_TYPES(BM_Sort, CCircularBuffer, Capacities);
+BENCHMARK_ALL_TYPES(BM_Sort, std::deque, Capacities);
+BENCHMARK_ALL_TYPES(BM_Sort, std::vector, Capacities);
+
+BENCHMARK_ALL_TYPES(BM_InsertEraseMiddle, CCircularBufferExt, Capacities);
+BENCHMARK_ALL_TYPES(BM_InsertEraseMiddle, std::deque, Capacities);
+BENCHMARK_ALL_TYPES(BM_InsertEraseMiddle, std::vector, Capacities);
+
+BENCHMARK_ALL_TYPES(BM_GrowFromEmpty, CCircularBufferExt, Capacities);
+BENCHMARK_ALL_TYPES(BM_GrowFromEmpty, std::deque, Capacities);
+BENCHMARK_ALL_TYPES(BM_GrowFromEmpty, std::vector, Capacities);
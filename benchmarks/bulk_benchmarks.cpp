@@ -0,0 +1,309 @@
+#include "lib/BufferSnapshot.h"
+#include "lib/BufferStats.h"
+#include "lib/CCircularBuffer.h"
+#include "lib/MagicCircularBuffer.h"
+#include "lib/MappedCircularBuffer.h"
+#include "lib/PmrCircularBuffer.h"
+#include "lib/StaticCircularBuffer.h"
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+template<class Buffer>
+static void BM_PushPopLoop(benchmark::State& state) {
+    Buffer buffer(4096);
+    std::vector<char> input(state.range(0), 'x');
+    std::vector<char> output(state.range(0));
+
+    for (auto _ : state) {
+        for (char c : input) {
+            buffer.push_back(c);
+        }
+        for (char& c : output) {
+            c = buffer.pop_front();
+        }
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+template<class Buffer>
+static void BM_PushPopBulk(benchmark::State& state) {
+    Buffer buffer(4096);
+    std::vector<char> input(state.range(0), 'x');
+    std::vector<char> output(state.range(0));
+
+    for (auto _ : state) {
+        buffer.push_back_n(input.data(), input.size());
+        buffer.pop_front_n(output.data(), output.size());
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+template<class Buffer>
+static void BM_WrappedScan(benchmark::State& state) {
+    Buffer buffer(state.range(0));
+    for (size_t i = 0; i < buffer.capacity() + buffer.capacity() / 2; ++i) {
+        buffer.push_back(static_cast<int>(i));
+    }
+
+    for (auto _ : state) {
+        long long sum = 0;
+        for (auto i = buffer.begin(); i != buffer.end(); ++i) {
+            sum += *i;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * buffer.size());
+}
+
+template<typename T>
+static void BM_IteratorAccumulate(benchmark::State& state) {
+    CCircularBuffer<T> buffer(state.range(0));
+    for (size_t i = 0; i < buffer.capacity() + buffer.capacity() / 2; ++i) {
+        buffer.push_back(static_cast<T>(i));
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::accumulate(buffer.begin(), buffer.end(), T()));
+    }
+    state.SetItemsProcessed(state.iterations() * buffer.size());
+}
+
+template<typename T>
+static void BM_SegmentedAccumulate(benchmark::State& state) {
+    CCircularBuffer<T> buffer(state.range(0));
+    for (size_t i = 0; i < buffer.capacity() + buffer.capacity() / 2; ++i) {
+        buffer.push_back(static_cast<T>(i));
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(accumulate(buffer, T()));
+    }
+    state.SetItemsProcessed(state.iterations() * buffer.size());
+}
+
+static void BM_BufferChurnDefault(benchmark::State& state) {
+    for (auto _ : state) {
+        CCircularBufferPow2<char> buffer(state.range(0));
+        buffer.push_back('x');
+        benchmark::DoNotOptimize(buffer.front());
+    }
+}
+
+static void BM_BufferChurnPool(benchmark::State& state) {
+    RingStoragePool pool;
+    for (auto _ : state) {
+        pmr::CCircularBufferPow2<char> buffer(state.range(0), &pool);
+        buffer.push_back('x');
+        benchmark::DoNotOptimize(buffer.front());
+    }
+}
+
+template<class Buffer>
+static void BM_SmallRingSession(benchmark::State& state) {
+    for (auto _ : state) {
+        Buffer buffer;
+        for (int i = 0; i < 24; ++i) {
+            buffer.push_back(i);
+        }
+        benchmark::DoNotOptimize(buffer.front() + buffer.back());
+    }
+}
+
+struct SmallPow2Ring : CCircularBufferPow2<int> {
+    SmallPow2Ring() : CCircularBufferPow2<int>(15) {}
+};
+
+template<class Buffer>
+static Buffer wrapped_window(size_t size_, int seed) {
+    Buffer buffer(size_);
+    for (size_t i = 0; i < size_ + size_ / 3; ++i) {
+        buffer.push_back(seed + static_cast<int>(i));
+    }
+
+    return buffer;
+}
+
+// Element by element reset, the way assign used to do it.
+template<class Buffer>
+static void BM_ResetWindowPopPush(benchmark::State& state) {
+    Buffer window = wrapped_window<Buffer>(state.range(0), 0);
+    Buffer snapshot = wrapped_window<Buffer>(state.range(0), 7);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            window.pop_front();
+        }
+        for (size_t i = snapshot.size(); i-- > 0;) {
+            window.push_front(snapshot[i]);
+        }
+        benchmark::DoNotOptimize(window.front());
+    }
+    state.SetItemsProcessed(state.iterations() * snapshot.size());
+}
+
+template<class Buffer>
+static void BM_ResetWindowAssign(benchmark::State& state) {
+    Buffer window = wrapped_window<Buffer>(state.range(0), 0);
+    Buffer snapshot = wrapped_window<Buffer>(state.range(0), 7);
+
+    for (auto _ : state) {
+        window.assign(snapshot);
+        benchmark::DoNotOptimize(window.front());
+    }
+    state.SetItemsProcessed(state.iterations() * snapshot.size());
+}
+
+BENCHMARK_TEMPLATE(BM_PushPopLoop, CCircularBuffer<char>)->Arg(64)->Arg(1500);
+BENCHMARK_TEMPLATE(BM_PushPopBulk, CCircularBuffer<char>)->Arg(64)->Arg(1500);
+BENCHMARK_TEMPLATE(BM_PushPopLoop, CCircularBuffer<char, std::allocator<char>, ModuloIndexing, BufferStats>)->Arg(1500);
+BENCHMARK_TEMPLATE(BM_PushPopLoop, CCircularBuffer<char, std::allocator<char>, ModuloIndexing, LatencyStats>)->Arg(1500);
+BENCHMARK_TEMPLATE(BM_WrappedScan, CCircularBuffer<int>)->Arg(1024)->Arg(65536);
+BENCHMARK_TEMPLATE(BM_IteratorAccumulate, int)->Arg(1024)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_SegmentedAccumulate, int)->Arg(1024)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_IteratorAccumulate, double)->Arg(1024)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_SegmentedAccumulate, double)->Arg(1024)->Arg(1 << 20);
+
+BENCHMARK(BM_BufferChurnDefault)->Arg(4095)->Arg(65535);
+BENCHMARK(BM_BufferChurnPool)->Arg(4095)->Arg(65535);
+
+BENCHMARK_TEMPLATE(BM_SmallRingSession, SmallPow2Ring);
+BENCHMARK_TEMPLATE(BM_SmallRingSession, StaticCircularBuffer<int, 16>);
+
+BENCHMARK_TEMPLATE(BM_ResetWindowPopPush, CCircularBuffer<int>)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_ResetWindowAssign, CCircularBuffer<int>)->Arg(1 << 20);
+
+#ifdef __linux__
+static std::string journal_path(const char* name) {
+    return std::string("/tmp/") + name + ".journal";
+}
+
+// Restart of a process that kept a journal of range(0) events in a mapped file.
+static void BM_JournalReattach(benchmark::State& state) {
+    std::string path = journal_path("reattach");
+    std::remove(path.c_str());
+    {
+        MappedCircularBuffer<uint64_t> journal(path, state.range(0));
+        std::vector<uint64_t> events(state.range(0));
+        std::iota(events.begin(), events.end(), 0);
+        journal.push_back_n(events.data(), events.size());
+    }
+
+    for (auto _ : state) {
+        MappedCircularBuffer<uint64_t> journal(path, state.range(0));
+        benchmark::DoNotOptimize(journal.back());
+    }
+    std::remove(path.c_str());
+}
+
+// The same restart when the journal was written to a file and is replayed into a CCircularBuffer.
+static void BM_JournalReplay(benchmark::State& state) {
+    std::string path = journal_path("replay");
+    {
+        std::vector<uint64_t> events(state.range(0));
+        std::iota(events.begin(), events.end(), 0);
+        FILE* file = std::fopen(path.c_str(), "wb");
+        std::fwrite(events.data(), sizeof(uint64_t), events.size(), file);
+        std::fclose(file);
+    }
+
+    std::vector<uint64_t> chunk(4096);
+    for (auto _ : state) {
+        CCircularBuffer<uint64_t> journal(state.range(0));
+        FILE* file = std::fopen(path.c_str(), "rb");
+        size_t count;
+        while ((count = std::fread(chunk.data(), sizeof(uint64_t), chunk.size(), file)) != 0) {
+            journal.push_back_n(chunk.data(), count);
+        }
+        std::fclose(file);
+        benchmark::DoNotOptimize(journal.back());
+    }
+    std::remove(path.c_str());
+}
+
+static CCircularBuffer<uint64_t> checkpoint_window(size_t count) {
+    CCircularBuffer<uint64_t> window(count);
+    for (uint64_t i = 0; i < count + count / 2; ++i) {
+        window.push_back(i);
+    }
+
+    return window;
+}
+
+// Checkpoint of a wrapped window written element by element through the iterator.
+static void BM_CheckpointIterate(benchmark::State& state) {
+    CCircularBuffer<uint64_t> window = checkpoint_window(state.range(0));
+    std::string path = journal_path("checkpoint_iterate");
+
+    for (auto _ : state) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        for (uint64_t element_ : window) {
+            out.write(reinterpret_cast<const char*>(&element_), sizeof(element_));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(uint64_t));
+    std::remove(path.c_str());
+}
+
+static void BM_CheckpointStream(benchmark::State& state) {
+    CCircularBuffer<uint64_t> window = checkpoint_window(state.range(0));
+    std::string path = journal_path("checkpoint_stream");
+
+    for (auto _ : state) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        save(window, out);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(uint64_t));
+    std::remove(path.c_str());
+}
+
+static void BM_CheckpointWritev(benchmark::State& state) {
+    CCircularBuffer<uint64_t> window = checkpoint_window(state.range(0));
+    std::string path = journal_path("checkpoint_writev");
+
+    for (auto _ : state) {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        save(window, fd);
+        close(fd);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(uint64_t));
+    std::remove(path.c_str());
+}
+
+static void BM_CheckpointRestore(benchmark::State& state) {
+    std::string path = journal_path("checkpoint_restore");
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    save(checkpoint_window(state.range(0)), fd);
+
+    for (auto _ : state) {
+        lseek(fd, 0, SEEK_SET);
+        CCircularBuffer<uint64_t> window(0);
+        load(window, fd);
+        benchmark::DoNotOptimize(window.back());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(uint64_t));
+    close(fd);
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_JournalReattach)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK(BM_JournalReplay)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK(BM_CheckpointIterate)->Arg(1 << 20)->Arg(10000000);
+BENCHMARK(BM_CheckpointStream)->Arg(1 << 20)->Arg(10000000);
+BENCHMARK(BM_CheckpointWritev)->Arg(1 << 20)->Arg(10000000);
+BENCHMARK(BM_CheckpointRestore)->Arg(1 << 20)->Arg(10000000);
+BENCHMARK_TEMPLATE(BM_PushPopLoop, MagicCircularBuffer<char>)->Arg(64)->Arg(1500);
+BENCHMARK_TEMPLATE(BM_PushPopBulk, MagicCircularBuffer<char>)->Arg(64)->Arg(1500);
+BENCHMARK_TEMPLATE(BM_WrappedScan, MagicCircularBuffer<int>)->Arg(1024)->Arg(65536);
+#endif
@@ -0,0 +1,215 @@
+#include "lib/BlockingCircularBuffer.h"
+#include "lib/BroadcastCircularBuffer.h"
+#include "lib/CCircularBuffer.h"
+#include "lib/ConcurrentCircularBuffer.h"
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const size_t kTransferItems = 1 << 16;
+
+static void BM_SpscTransfer(benchmark::State& state) {
+    SpscCircularBuffer<int, std::allocator<int>, Pow2Indexing> queue(state.range(0));
+
+    for (auto _ : state) {
+        std::thread consumer([&queue]() {
+            int value;
+            for (size_t i = 0; i < kTransferItems;) {
+                if (queue.try_pop(value)) {
+                    benchmark::DoNotOptimize(value);
+                    ++i;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        for (size_t i = 0; i < kTransferItems;) {
+            if (queue.try_push(static_cast<int>(i))) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * kTransferItems);
+}
+
+static void BM_MutexTransfer(benchmark::State& state) {
+    CCircularBufferPow2<int> queue(state.range(0));
+    std::mutex mutex;
+
+    for (auto _ : state) {
+        std::thread consumer([&queue, &mutex]() {
+            for (size_t i = 0; i < kTransferItems;) {
+                bool popped = false;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!queue.empty()) {
+                        benchmark::DoNotOptimize(queue.pop_front());
+                        popped = true;
+                    }
+                }
+                if (popped) {
+                    ++i;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        for (size_t i = 0; i < kTransferItems;) {
+            bool pushed = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (queue.size() + 1 < queue.capacity()) {
+                    queue.push_back(static_cast<int>(i));
+                    pushed = true;
+                }
+            }
+            if (pushed) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * kTransferItems);
+}
+
+static void BM_BlockingTransfer(benchmark::State& state) {
+    BlockingCircularBuffer<int, std::allocator<int>, Pow2Indexing> queue(state.range(0));
+
+    for (auto _ : state) {
+        std::thread consumer([&queue]() {
+            for (size_t i = 0; i < kTransferItems; ++i) {
+                benchmark::DoNotOptimize(queue.pop());
+            }
+        });
+
+        for (size_t i = 0; i < kTransferItems; ++i) {
+            queue.push(static_cast<int>(i));
+        }
+        consumer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * kTransferItems);
+}
+
+static void BM_BlockingBatchTransfer(benchmark::State& state) {
+    BlockingCircularBuffer<int, std::allocator<int>, Pow2Indexing> queue(state.range(0));
+    std::vector<int> batch(64);
+
+    for (auto _ : state) {
+        std::thread consumer([&queue]() {
+            std::vector<int> out;
+            out.reserve(kTransferItems);
+            while (out.size() < kTransferItems) {
+                if (queue.drain_into(std::back_inserter(out), kTransferItems - out.size()) == 0) {
+                    out.push_back(queue.pop());
+                }
+            }
+            benchmark::DoNotOptimize(out.data());
+        });
+
+        for (size_t i = 0; i < kTransferItems; i += batch.size()) {
+            queue.push_n(batch.data(), batch.size());
+        }
+        consumer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * kTransferItems);
+}
+
+BENCHMARK(BM_SpscTransfer)->Arg(1023)->Arg(65535)->UseRealTime();
+BENCHMARK(BM_MutexTransfer)->Arg(1023)->Arg(65535)->UseRealTime();
+BENCHMARK(BM_BlockingTransfer)->Arg(1023)->Arg(65535)->UseRealTime();
+BENCHMARK(BM_BlockingBatchTransfer)->Arg(1023)->Arg(65535)->UseRealTime();
+
+static MpmcCircularBuffer<int, std::allocator<int>, Pow2Indexing>* shared_mpmc = nullptr;
+
+static void BM_MpmcPushPop(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        shared_mpmc = new MpmcCircularBuffer<int, std::allocator<int>, Pow2Indexing>(1024);
+    }
+
+    for (auto _ : state) {
+        shared_mpmc->push(1);
+        benchmark::DoNotOptimize(shared_mpmc->pop());
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        delete shared_mpmc;
+    }
+}
+
+static CCircularBufferPow2<int>* shared_locked = nullptr;
+static std::mutex shared_mutex;
+
+static void BM_MutexPushPop(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        shared_locked = new CCircularBufferPow2<int>(1024);
+    }
+
+    for (auto _ : state) {
+        {
+            std::lock_guard<std::mutex> lock(shared_mutex);
+            shared_locked->push_back(1);
+        }
+        {
+            std::lock_guard<std::mutex> lock(shared_mutex);
+            benchmark::DoNotOptimize(shared_locked->pop_front());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        delete shared_locked;
+    }
+}
+
+BENCHMARK(BM_MpmcPushPop)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_MutexPushPop)->ThreadRange(1, 16)->UseRealTime();
+
+const size_t kFanOutReaders = 3;
+
+// Every consumer gets its own copy of the data, the way it is done without a broadcast ring.
+static void BM_FanOutCopies(benchmark::State& state) {
+    std::vector<CCircularBufferPow2<int>> queues(kFanOutReaders, CCircularBufferPow2<int>(4095));
+    std::vector<int> batch(state.range(0), 1);
+    std::vector<int> out(state.range(0));
+
+    for (auto _ : state) {
+        for (auto& queue : queues) {
+            queue.push_back_n(batch.data(), batch.size());
+        }
+        for (auto& queue : queues) {
+            benchmark::DoNotOptimize(queue.pop_front_n(out.data(), out.size()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_BroadcastReaders(benchmark::State& state) {
+    BroadcastCircularBuffer<int, std::allocator<int>, Pow2Indexing> ring(4095);
+    std::vector<BroadcastCircularBuffer<int, std::allocator<int>, Pow2Indexing>::Reader> readers;
+    for (size_t i = 0; i < kFanOutReaders; ++i) {
+        readers.push_back(ring.reader());
+    }
+    std::vector<int> batch(state.range(0), 1);
+    std::vector<int> out(state.range(0));
+
+    for (auto _ : state) {
+        ring.push_back_n(batch.data(), batch.size());
+        for (auto& reader : readers) {
+            benchmark::DoNotOptimize(reader.read_n(out.data(), out.size()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_FanOutCopies)->Arg(1)->Arg(64);
+BENCHMARK(BM_BroadcastReaders)->Arg(1)->Arg(64);
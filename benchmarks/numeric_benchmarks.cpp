@@ -0,0 +1,157 @@
+#include "lib/NumericCircularBuffer.h"
+#include "lib/RollingCircularBuffer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+template<typename T>
+static CCircularBuffer<T> make_wrapped(size_t capacity_) {
+    CCircularBuffer<T> buffer(capacity_);
+    for (size_t i = 0; i < capacity_ + capacity_ / 2; ++i) {
+        buffer.push_back(static_cast<T>(i % 1000) / 7);
+    }
+
+    return buffer;
+}
+
+static void KernelSets(benchmark::internal::Benchmark* benchmark) {
+    for (KernelSet kernel_set : {KernelSet::kScalar, KernelSet::kSse2, KernelSet::kAvx2}) {
+        for (int64_t capacity_ : {1024, 1 << 20}) {
+            benchmark->Args({capacity_, static_cast<int64_t>(kernel_set)});
+        }
+    }
+}
+
+template<typename T>
+static bool select_kernels(benchmark::State& state, NumericKernels<T>& kernels) {
+    KernelSet kernel_set = static_cast<KernelSet>(state.range(1));
+    if (!NumericKernels<T>::supported(kernel_set)) {
+        state.SkipWithError("kernel set is not supported by this CPU");
+        return false;
+    }
+    kernels = NumericKernels<T>::get(kernel_set);
+
+    return true;
+}
+
+template<typename T>
+static void BM_IteratorSum(benchmark::State& state) {
+    CCircularBuffer<T> buffer = make_wrapped<T>(state.range(0));
+
+    for (auto _ : state) {
+        T result = 0;
+        for (auto i = buffer.begin(); i != buffer.end(); ++i) {
+            result += *i;
+        }
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * buffer.size());
+}
+
+template<typename T>
+static void BM_KernelSum(benchmark::State& state) {
+    CCircularBuffer<T> buffer = make_wrapped<T>(state.range(0));
+    NumericKernels<T> kernels;
+    if (!select_kernels(state, kernels))
+        return;
+
+    for (auto _ : state) {
+        auto one = buffer.array_one();
+        auto two = buffer.array_two();
+        benchmark::DoNotOptimize(kernels.sum(one.first, one.second) + kernels.sum(two.first, two.second));
+    }
+    state.SetItemsProcessed(state.iterations() * buffer.size());
+}
+
+template<typename T>
+static void BM_KernelMinMax(benchmark::State& state) {
+    CCircularBuffer<T> buffer = make_wrapped<T>(state.range(0));
+    NumericKernels<T> kernels;
+    if (!select_kernels(state, kernels))
+        return;
+
+    for (auto _ : state) {
+        auto one = buffer.array_one();
+        auto two = buffer.array_two();
+        benchmark::DoNotOptimize(kernels.min(one.first, one.second) + kernels.max(two.first, two.second));
+    }
+    state.SetItemsProcessed(state.iterations() * buffer.size());
+}
+
+template<typename T>
+static void BM_KernelVariance(benchmark::State& state) {
+    CCircularBuffer<T> buffer = make_wrapped<T>(state.range(0));
+    NumericKernels<T> kernels;
+    if (!select_kernels(state, kernels))
+        return;
+
+    for (auto _ : state) {
+        auto one = buffer.array_one();
+        auto two = buffer.array_two();
+        T mean_ = (kernels.sum(one.first, one.second) + kernels.sum(two.first, two.second)) / buffer.size();
+        benchmark::DoNotOptimize(kernels.squared_deviation(one.first, one.second, mean_) +
+                                 kernels.squared_deviation(two.first, two.second, mean_));
+    }
+    state.SetItemsProcessed(state.iterations() * buffer.size());
+}
+
+template<typename T>
+static void BM_KernelFir(benchmark::State& state) {
+    CCircularBuffer<T> buffer = make_wrapped<T>(state.range(0));
+    std::vector<T> coefficients(buffer.size(), static_cast<T>(0.5));
+    NumericKernels<T> kernels;
+    if (!select_kernels(state, kernels))
+        return;
+
+    for (auto _ : state) {
+        auto one = buffer.array_one();
+        auto two = buffer.array_two();
+        benchmark::DoNotOptimize(kernels.dot(one.first, coefficients.data(), one.second) +
+                                 kernels.dot(two.first, coefficients.data() + one.second, two.second));
+    }
+    state.SetItemsProcessed(state.iterations() * buffer.size());
+}
+
+BENCHMARK_TEMPLATE(BM_IteratorSum, float)->Arg(1024)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_IteratorSum, double)->Arg(1024)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_KernelSum, float)->Apply(KernelSets);
+BENCHMARK_TEMPLATE(BM_KernelSum, double)->Apply(KernelSets);
+BENCHMARK_TEMPLATE(BM_KernelMinMax, float)->Apply(KernelSets);
+BENCHMARK_TEMPLATE(BM_KernelMinMax, double)->Apply(KernelSets);
+BENCHMARK_TEMPLATE(BM_KernelVariance, float)->Apply(KernelSets);
+BENCHMARK_TEMPLATE(BM_KernelVariance, double)->Apply(KernelSets);
+BENCHMARK_TEMPLATE(BM_KernelFir, float)->Apply(KernelSets);
+BENCHMARK_TEMPLATE(BM_KernelFir, double)->Apply(KernelSets);
+
+static void BM_RecomputeTick(benchmark::State& state) {
+    CCircularBuffer<double> buffer = make_wrapped<double>(state.range(0));
+    double value = 0;
+
+    for (auto _ : state) {
+        buffer.push_back(value += 0.25);
+        benchmark::DoNotOptimize(variance(buffer));
+        benchmark::DoNotOptimize(minimum(buffer));
+        benchmark::DoNotOptimize(maximum(buffer));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_RollingTick(benchmark::State& state) {
+    RollingCircularBuffer<double, RollingSum, RollingSumOfSquares, RollingMin, RollingMax> buffer(state.range(0));
+    for (size_t i = 0; i < buffer.capacity(); ++i) {
+        buffer.push_back(static_cast<double>(i % 1000) / 7);
+    }
+    double value = 0;
+
+    for (auto _ : state) {
+        buffer.push_back(value += 0.25);
+        benchmark::DoNotOptimize(buffer.variance());
+        benchmark::DoNotOptimize(buffer.min());
+        benchmark::DoNotOptimize(buffer.max());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RecomputeTick)->Arg(1024)->Arg(100000);
+BENCHMARK(BM_RollingTick)->Arg(1024)->Arg(100000);
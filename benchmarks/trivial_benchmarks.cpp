@@ -0,0 +1,97 @@
+#include "lib/CCircularBuffer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+// Same layout twice: the trivially copyable Blob takes the memcpy/memmove paths, while
+// the user-provided copy operations of OpaqueBlob force the per-element ones.
+template<size_t Bytes>
+struct Blob {
+    char bytes[Bytes];
+};
+
+template<size_t Bytes>
+struct OpaqueBlob {
+    char bytes[Bytes];
+
+    OpaqueBlob() = default;
+
+    OpaqueBlob(const OpaqueBlob& rhs) {
+        std::memcpy(bytes, rhs.bytes, Bytes);
+    }
+
+    OpaqueBlob& operator=(const OpaqueBlob& rhs) {
+        std::memcpy(bytes, rhs.bytes, Bytes);
+
+        return *this;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Blob<8>>);
+static_assert(!std::is_trivially_copyable_v<OpaqueBlob<8>>);
+
+template<class Buffer>
+static Buffer make_half_wrapped(size_t capacity_) {
+    Buffer buffer(capacity_);
+    typename Buffer::value_type value{};
+    for (size_t i = 0; i < capacity_ + capacity_ / 2; ++i) {
+        value.bytes[0] = static_cast<char>(i);
+        buffer.push_back(value);
+    }
+
+    return buffer;
+}
+
+template<typename T>
+static void BM_CopyConstruct(benchmark::State& state) {
+    CCircularBuffer<T> buffer = make_half_wrapped<CCircularBuffer<T>>(state.range(0));
+
+    for (auto _ : state) {
+        CCircularBuffer<T> copy(buffer);
+        benchmark::DoNotOptimize(copy.front());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size() * sizeof(T));
+}
+
+template<typename T>
+static void BM_InsertEraseFront(benchmark::State& state) {
+    CCircularBufferExt<T> buffer = make_half_wrapped<CCircularBufferExt<T>>(state.range(0));
+    T value{};
+
+    for (auto _ : state) {
+        buffer.insert(value, buffer.begin() + 1);
+        buffer.erase(1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename T, class Allocator = std::allocator<T>>
+static void BM_ExtGrowth(benchmark::State& state) {
+    T value{};
+
+    for (auto _ : state) {
+        CCircularBufferExt<T, Allocator> buffer;
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            buffer.push_back(value);
+        }
+        benchmark::DoNotOptimize(buffer.back());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+#define BENCHMARK_BLOB_SIZES(name, ...)                                                     \
+    BENCHMARK_TEMPLATE(name, Blob<8>)->Arg(4096)->Arg(65536) __VA_ARGS__;                   \
+    BENCHMARK_TEMPLATE(name, OpaqueBlob<8>)->Arg(4096)->Arg(65536) __VA_ARGS__;             \
+    BENCHMARK_TEMPLATE(name, Blob<32>)->Arg(4096)->Arg(65536) __VA_ARGS__;                  \
+    BENCHMARK_TEMPLATE(name, OpaqueBlob<32>)->Arg(4096)->Arg(65536) __VA_ARGS__;            \
+    BENCHMARK_TEMPLATE(name, Blob<64>)->Arg(4096)->Arg(65536) __VA_ARGS__;                  \
+    BENCHMARK_TEMPLATE(name, OpaqueBlob<64>)->Arg(4096)->Arg(65536) __VA_ARGS__;            \
+    BENCHMARK_TEMPLATE(name, Blob<256>)->Arg(4096)->Arg(65536) __VA_ARGS__;                 \
+    BENCHMARK_TEMPLATE(name, OpaqueBlob<256>)->Arg(4096)->Arg(65536) __VA_ARGS__
+
+BENCHMARK_BLOB_SIZES(BM_CopyConstruct);
+BENCHMARK_BLOB_SIZES(BM_InsertEraseFront);
+BENCHMARK_BLOB_SIZES(BM_ExtGrowth);
+BENCHMARK_TEMPLATE(BM_ExtGrowth, Blob<8>, ReallocAllocator<Blob<8>>)->Arg(4096)->Arg(65536);
+BENCHMARK_TEMPLATE(BM_ExtGrowth, Blob<64>, ReallocAllocator<Blob<64>>)->Arg(4096)->Arg(65536);
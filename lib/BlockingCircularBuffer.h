@@ -0,0 +1,295 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+#include "ConcurrentCircularBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+const size_t kMinSpinsBeforePark = 16;
+const size_t kMaxSpinsBeforePark = 4096;
+
+// Bounded queue for producer and consumer threads that want to sleep instead of polling. The ring itself
+// is a CCircularBuffer under a mutex. A thread that has to wait first spins on an atomic copy of the size,
+// with a spin budget that doubles when spinning paid off and halves when it did not, and then parks on a
+// condition variable (a futex on Linux). Parked threads are only woken when there is work for them, and no
+// more of them than there is work: a batch pushed with push_n costs at most one notification, and a woken
+// consumer passes the wakeup on if elements are left behind.
+template<typename T, class Allocator = std::allocator<T>, class Indexing = ModuloIndexing>
+class BlockingCircularBuffer {
+private:
+    enum class Wakeup {
+        kNone,
+        kOne,
+        kAll
+    };
+
+    struct Sleepers {
+        std::condition_variable condition;
+        size_t parked = 0;
+        size_t signalled = 0;
+
+        // Called under the lock when `available` units of work are ready for this side. Parked threads that
+        // were already signalled are counted as taking work, so repeated calls do not notify them again.
+        Wakeup plan(size_t available) {
+            size_t idle = parked - signalled;
+            size_t wanted = available > signalled ? available - signalled : 0;
+            size_t count = std::min(idle, wanted);
+            if (count == 0) {
+                return Wakeup::kNone;
+            }
+            if (count == 1) {
+                signalled++;
+
+                return Wakeup::kOne;
+            }
+            signalled = parked;
+
+            return Wakeup::kAll;
+        }
+
+        void wake(Wakeup wakeup) {
+            if (wakeup == Wakeup::kOne) {
+                condition.notify_one();
+            } else if (wakeup == Wakeup::kAll) {
+                condition.notify_all();
+            }
+        }
+    };
+
+    CCircularBuffer<T, Allocator, Indexing> buffer_;
+    size_t capacity_ = 0;
+    FullPolicy policy_ = FullPolicy::kBlock;
+
+    std::mutex mutex_;
+    Sleepers consumers_;
+    Sleepers producers_;
+
+    alignas(kCacheLineSize) std::atomic<size_t> size_{0};
+    std::atomic<size_t> spin_limit_{kMinSpinsBeforePark};
+
+    static void relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    bool has_elements() const {
+        return size_.load(std::memory_order_acquire) != 0;
+    }
+
+    bool has_space() const {
+        return size_.load(std::memory_order_acquire) < capacity_;
+    }
+
+    template<class Ready>
+    bool spin(Ready ready) {
+        size_t limit = spin_limit_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < limit; ++i) {
+            if (ready()) {
+                spin_limit_.store(std::min(limit * 2, kMaxSpinsBeforePark), std::memory_order_relaxed);
+
+                return true;
+            }
+            relax();
+        }
+        spin_limit_.store(std::max(limit / 2, kMinSpinsBeforePark), std::memory_order_relaxed);
+
+        return false;
+    }
+
+    // Waits with the lock held on entry and exit until ready(). park(lock) blocks on the condition variable
+    // and returns false on timeout, in which case the result is whether ready() holds after all.
+    template<class Ready, class Park>
+    bool wait(std::unique_lock<std::mutex>& lock, Sleepers& sleepers, Ready ready, Park park) {
+        if (ready())
+            return true;
+
+        lock.unlock();
+        spin(ready);
+        lock.lock();
+        while (!ready()) {
+            sleepers.parked++;
+            bool woken = park(lock);
+            sleepers.parked--;
+            if (sleepers.signalled > 0) {
+                sleepers.signalled--;
+            }
+            if (!woken)
+                return ready();
+        }
+
+        return true;
+    }
+
+    template<class Ready>
+    void wait(std::unique_lock<std::mutex>& lock, Sleepers& sleepers, Ready ready) {
+        wait(lock, sleepers, ready, [&sleepers](std::unique_lock<std::mutex>& lock_) {
+            sleepers.condition.wait(lock_);
+
+            return true;
+        });
+    }
+
+    // Publishes the new size, releases the lock and then wakes whoever has work now.
+    void publish(std::unique_lock<std::mutex>& lock) {
+        size_t size = buffer_.size();
+        size_.store(size, std::memory_order_release);
+        Wakeup consumers = consumers_.plan(size);
+        Wakeup producers = producers_.plan(capacity_ - size);
+        lock.unlock();
+
+        consumers_.wake(consumers);
+        producers_.wake(producers);
+    }
+
+    T take(std::unique_lock<std::mutex>& lock) {
+        T element_ = buffer_.pop_front();
+        publish(lock);
+
+        return element_;
+    }
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef Allocator           allocator_type;
+
+    explicit BlockingCircularBuffer(size_t _capacity_, FullPolicy policy = FullPolicy::kBlock,
+                                    const Allocator& allocator_ = Allocator())
+        : buffer_(_capacity_, allocator_), capacity_(_capacity_), policy_(policy) {
+        if (_capacity_ == 0)
+            throw std::invalid_argument("Error: blocking buffer must hold at least one element");
+    }
+
+    BlockingCircularBuffer() : BlockingCircularBuffer(kDefaultCapacity) {}
+
+    BlockingCircularBuffer(const BlockingCircularBuffer&) = delete;
+    BlockingCircularBuffer& operator=(const BlockingCircularBuffer&) = delete;
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    FullPolicy policy() const {
+        return policy_;
+    }
+
+    // Returns false only under FullPolicy::kReject when the buffer is full. Under kBlock it waits for space,
+    // under kOverwrite it evicts the oldest element.
+    template<typename... Args>
+    bool emplace(Args&&... args) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (buffer_.size() == capacity_) {
+            if (policy_ == FullPolicy::kReject)
+                return false;
+            if (policy_ == FullPolicy::kBlock) {
+                wait(lock, producers_, [this] { return has_space(); });
+            } else {
+                buffer_.consume(1);
+            }
+        }
+        buffer_.emplace_back(std::forward<Args>(args)...);
+        publish(lock);
+
+        return true;
+    }
+
+    bool push(const_reference element_) {
+        return emplace(element_);
+    }
+
+    bool push(T&& element_) {
+        return emplace(std::move(element_));
+    }
+
+    // Pushes count elements at once and returns how many were stored: all of them under kOverwrite (the
+    // oldest are evicted) and kBlock (waiting for space as many times as needed), as many as fit under kReject.
+    size_t push_n(const T* from_, size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (policy_ == FullPolicy::kOverwrite) {
+            size_t kept = std::min(count, capacity_);
+            if (buffer_.size() + kept > capacity_) {
+                buffer_.consume(buffer_.size() + kept - capacity_);
+            }
+            buffer_.push_back_n(from_ + count - kept, kept);
+            publish(lock);
+
+            return count;
+        }
+
+        size_t pushed = 0;
+        for (;;) {
+            size_t n = std::min(count - pushed, capacity_ - buffer_.size());
+            buffer_.push_back_n(from_ + pushed, n);
+            pushed += n;
+            if (pushed == count || policy_ == FullPolicy::kReject) {
+                break;
+            }
+            publish(lock);
+            lock.lock();
+            wait(lock, producers_, [this] { return has_space(); });
+        }
+        publish(lock);
+
+        return pushed;
+    }
+
+    T pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wait(lock, consumers_, [this] { return has_elements(); });
+
+        return take(lock);
+    }
+
+    template<class Rep, class Period>
+    std::optional<T> pop_for(const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool ready = wait(lock, consumers_, [this] { return has_elements(); },
+                          [this, deadline](std::unique_lock<std::mutex>& lock_) {
+                              return consumers_.condition.wait_until(lock_, deadline) == std::cv_status::no_timeout;
+                          });
+        if (!ready)
+            return std::nullopt;
+
+        return take(lock);
+    }
+
+    // Moves up to max elements to out without waiting and returns how many were moved.
+    template<class OutputIt>
+    size_t drain_into(OutputIt out, size_t max) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t count = std::min(max, buffer_.size());
+        auto one = buffer_.array_one();
+        auto two = buffer_.array_two();
+        size_t first = std::min(count, one.second);
+        out = std::move(one.first, one.first + first, out);
+        std::move(two.first, two.first + (count - first), out);
+        buffer_.consume(count);
+        publish(lock);
+
+        return count;
+    }
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+#include "ConcurrentCircularBuffer.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// Ring with a single writer and any number of readers, each with its own cursor. The writer never waits:
+// like CCircularBuffer it overwrites the oldest element when the ring is full. Readers do not register
+// and take no locks. They copy elements out and then check that the writer did not start overwriting
+// what they copied (a seqlock over two counters), so T must be trivially copyable. A reader that fell
+// more than capacity() elements behind skips to the oldest element still stored and counts the skipped
+// ones in lost().
+template<typename T, class Allocator = std::allocator<T>, class Indexing = ModuloIndexing>
+class BroadcastCircularBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "BroadcastCircularBuffer copies elements racily and requires trivially copyable T");
+private:
+    typedef std::allocator_traits<Allocator> alloc_traits;
+
+    T* elements = nullptr;
+    Allocator allocator;
+    size_t capacity_ = 0;
+
+    // The writer bumps claimed_ before it touches a slot and published_ once the element is written.
+    alignas(kCacheLineSize) std::atomic<uint64_t> claimed_{0};
+    std::atomic<uint64_t> published_{0};
+
+    size_t wrap(uint64_t idx) const {
+        return Indexing::wrap(idx, capacity_);
+    }
+
+    void copy_out(uint64_t from_, size_t count, T* to_) const {
+        size_t pos = wrap(from_);
+        size_t first = std::min(count, capacity_ - pos);
+        std::memcpy(static_cast<void*>(to_), elements + pos, first * sizeof(T));
+        std::memcpy(static_cast<void*>(to_ + first), elements, (count - first) * sizeof(T));
+    }
+
+    void copy_in(const T* from_, size_t count, uint64_t to_) {
+        size_t pos = wrap(to_);
+        size_t first = std::min(count, capacity_ - pos);
+        std::memcpy(static_cast<void*>(elements + pos), from_, first * sizeof(T));
+        std::memcpy(static_cast<void*>(elements), from_ + first, (count - first) * sizeof(T));
+    }
+public:
+    typedef T                   value_type;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef Allocator           allocator_type;
+
+    class Reader {
+        friend class BroadcastCircularBuffer;
+    private:
+        const BroadcastCircularBuffer* buffer_ = nullptr;
+        uint64_t cursor_ = 0;
+        uint64_t lost_ = 0;
+
+        Reader(const BroadcastCircularBuffer* _buffer_, uint64_t _cursor_) : buffer_(_buffer_), cursor_(_cursor_) {}
+
+        void skip_to(uint64_t oldest) {
+            if (cursor_ < oldest) {
+                lost_ += oldest - cursor_;
+                cursor_ = oldest;
+            }
+        }
+    public:
+        Reader() = default;
+
+        // Elements that can be read right now, not counting the ones already overwritten.
+        size_t available() const {
+            uint64_t published = buffer_->published_.load(std::memory_order_acquire);
+            if (cursor_ >= published)
+                return 0;
+
+            return static_cast<size_t>(std::min<uint64_t>(published - cursor_, buffer_->capacity()));
+        }
+
+        bool lapped() const {
+            uint64_t published = buffer_->published_.load(std::memory_order_acquire);
+
+            return published > cursor_ && published - cursor_ > buffer_->capacity();
+        }
+
+        uint64_t lost() const {
+            return lost_;
+        }
+
+        uint64_t position() const {
+            return cursor_;
+        }
+
+        size_t read_n(T* to_, size_t count) {
+            for (;;) {
+                uint64_t published = buffer_->published_.load(std::memory_order_acquire);
+                skip_to(published - std::min<uint64_t>(published, buffer_->capacity()));
+                if (cursor_ >= published)
+                    return 0;
+
+                size_t n = static_cast<size_t>(std::min<uint64_t>(count, published - cursor_));
+                buffer_->copy_out(cursor_, n, to_);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                uint64_t claimed = buffer_->claimed_.load(std::memory_order_relaxed);
+                if (claimed <= cursor_ + buffer_->capacity_) {
+                    cursor_ += n;
+
+                    return n;
+                }
+                skip_to(claimed - buffer_->capacity_);
+            }
+        }
+
+        bool try_read(T& element_) {
+            return read_n(&element_, 1) == 1;
+        }
+    };
+
+    explicit BroadcastCircularBuffer(size_t _capacity_, const Allocator& allocator_ = Allocator()) : allocator(allocator_) {
+        capacity_ = Indexing::storage_size(_capacity_);
+        elements = alloc_traits::allocate(allocator, capacity_);
+    }
+
+    BroadcastCircularBuffer() : BroadcastCircularBuffer(kDefaultCapacity) {}
+
+    BroadcastCircularBuffer(const BroadcastCircularBuffer&) = delete;
+    BroadcastCircularBuffer& operator=(const BroadcastCircularBuffer&) = delete;
+
+    ~BroadcastCircularBuffer() {
+        alloc_traits::deallocate(allocator, elements, capacity_);
+    }
+
+    // One slot is kept free for the element being written, so a reader can always get the last capacity() ones.
+    size_t capacity() const {
+        return capacity_ - 1;
+    }
+
+    size_t size() const {
+        return static_cast<size_t>(std::min<uint64_t>(published(), capacity()));
+    }
+
+    bool empty() const {
+        return published() == 0;
+    }
+
+    uint64_t published() const {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    // A reader that sees the elements pushed from now on.
+    Reader reader() const {
+        return Reader(this, published());
+    }
+
+    void push_back(const_reference element_) {
+        push_back_n(&element_, 1);
+    }
+
+    void push_back_n(const T* from_, size_t count) {
+        uint64_t end = published_.load(std::memory_order_relaxed);
+        if (count > capacity_) {
+            from_ += count - capacity_;
+            end += count - capacity_;
+            count = capacity_;
+        }
+
+        claimed_.store(end + count, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        copy_in(from_, count, end);
+        published_.store(end + count, std::memory_order_release);
+    }
+};
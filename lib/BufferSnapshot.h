@@ -0,0 +1,252 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <cerrno>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+const uint64_t kSnapshotMagic = 0x50414e5342434343;
+const uint32_t kSnapshotFormatVersion = 1;
+
+// Snapshot layout: this header followed by size elements from the front to the back. Elements of trivially
+// copyable T are stored as raw bytes (element_size is sizeof(T)), other elements by their SnapshotCodec
+// (element_size is 0). Fields use the byte order of the machine that saved the snapshot.
+struct SnapshotHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t element_size;
+    uint64_t capacity;
+    uint64_t size;
+};
+
+// Element format for save() and load() of T that is not trivially copyable. Specializations provide
+// static void encode(std::ostream&, const T&) and static T decode(std::istream&).
+template<typename T>
+struct SnapshotCodec;
+
+template<typename CharT, class Traits, class Allocator>
+struct SnapshotCodec<std::basic_string<CharT, Traits, Allocator>> {
+    typedef std::basic_string<CharT, Traits, Allocator> string_type;
+
+    static void encode(std::ostream& out, const string_type& element_) {
+        uint64_t length = element_.size();
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(reinterpret_cast<const char*>(element_.data()), element_.size() * sizeof(CharT));
+    }
+
+    static string_type decode(std::istream& in) {
+        uint64_t length = 0;
+        in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        string_type element_;
+        if (in) {
+            element_.resize(length);
+            in.read(reinterpret_cast<char*>(element_.data()), length * sizeof(CharT));
+        }
+
+        return element_;
+    }
+};
+
+template<typename T, class Allocator, class Indexing, class Stats>
+size_t snapshot_capacity(const CCircularBuffer<T, Allocator, Indexing, Stats>& buffer) {
+    return buffer.capacity() - 1;
+}
+
+template<typename T, class Allocator, class Indexing, class Stats>
+size_t snapshot_capacity(const CCircularBufferExt<T, Allocator, Indexing, Stats>& buffer) {
+    return buffer.capacity();
+}
+
+template<class Buffer>
+using enable_if_snapshot_t = decltype(snapshot_capacity(std::declval<const Buffer&>()), void());
+
+template<class Buffer>
+SnapshotHeader snapshot_header(const Buffer& buffer) {
+    typedef typename Buffer::value_type T;
+
+    return {kSnapshotMagic, kSnapshotFormatVersion,
+            std::is_trivially_copyable_v<T> ? static_cast<uint32_t>(sizeof(T)) : 0,
+            snapshot_capacity(buffer), buffer.size()};
+}
+
+// The header is checked before anything is allocated for it, so a corrupted capacity or size can neither
+// overflow the storage size nor make load() read more than the snapshot holds. remaining is the number
+// of bytes left after the header, or UINT64_MAX when the source cannot tell.
+template<class Buffer>
+void check_snapshot_header(const SnapshotHeader& header, const Buffer& buffer, uint64_t remaining) {
+    typedef typename Buffer::value_type T;
+
+    if (header.magic != kSnapshotMagic || header.version != kSnapshotFormatVersion)
+        throw std::invalid_argument("Error: not a circular buffer snapshot of a supported version");
+    if (header.element_size != (std::is_trivially_copyable_v<T> ? sizeof(T) : 0))
+        throw std::invalid_argument("Error: snapshot was saved for a different element type");
+    if (header.size > header.capacity)
+        throw std::invalid_argument("Error: snapshot holds more elements than its capacity");
+    if (header.capacity > buffer.max_size() || header.size > SIZE_MAX / sizeof(T))
+        throw std::invalid_argument("Error: snapshot capacity is too large");
+    if (std::is_trivially_copyable_v<T> && header.size * sizeof(T) > remaining)
+        throw std::invalid_argument("Error: snapshot is truncated");
+}
+
+inline uint64_t remaining_snapshot(std::istream& in) {
+    std::istream::pos_type here = in.tellg();
+    if (here == std::istream::pos_type(-1))
+        return UINT64_MAX;
+
+    in.seekg(0, std::ios_base::end);
+    std::istream::pos_type end = in.tellg();
+    in.seekg(here);
+    if (end == std::istream::pos_type(-1) || !in) {
+        in.clear();
+        return UINT64_MAX;
+    }
+
+    return static_cast<uint64_t>(end - here);
+}
+
+// Writes the header and the two storage segments, without walking the buffer element by element
+// for trivially copyable T.
+template<class Buffer, typename = enable_if_snapshot_t<Buffer>>
+void save(const Buffer& buffer, std::ostream& out) {
+    typedef typename Buffer::value_type T;
+
+    SnapshotHeader header = snapshot_header(buffer);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (auto segment : {buffer.array_one(), buffer.array_two()}) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            out.write(reinterpret_cast<const char*>(segment.first), segment.second * sizeof(T));
+        } else {
+            for (size_t i = 0; i < segment.second; ++i) {
+                SnapshotCodec<T>::encode(out, segment.first[i]);
+            }
+        }
+    }
+    if (!out)
+        throw std::ios_base::failure("Error: writing the snapshot failed");
+}
+
+// Replaces the contents of buffer with a snapshot. The restored buffer gets the saved capacity, is
+// allocated once and holds the elements linearized from the start of its storage. On error buffer
+// is left unchanged.
+template<class Buffer, typename = enable_if_snapshot_t<Buffer>>
+void load(Buffer& buffer, std::istream& in) {
+    typedef typename Buffer::value_type T;
+
+    SnapshotHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        throw std::invalid_argument("Error: snapshot is truncated");
+    check_snapshot_header(header, buffer, remaining_snapshot(in));
+
+    Buffer restored(header.capacity, buffer.get_allocator());
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        T* to_ = restored.prepare(header.size).first.first;
+        if (!in.read(reinterpret_cast<char*>(to_), header.size * sizeof(T)))
+            throw std::invalid_argument("Error: snapshot is truncated");
+        restored.commit(header.size);
+    } else {
+        for (uint64_t i = 0; i < header.size; ++i) {
+            T element_ = SnapshotCodec<T>::decode(in);
+            if (!in)
+                throw std::invalid_argument("Error: snapshot is truncated");
+            restored.push_back(std::move(element_));
+        }
+    }
+    buffer = std::move(restored);
+}
+
+#ifdef __linux__
+// Writes the header and both segments with a single writev (more only if the kernel writes partially).
+template<class Buffer, typename = enable_if_snapshot_t<Buffer>>
+void save(const Buffer& buffer, int fd) {
+    typedef typename Buffer::value_type T;
+    static_assert(std::is_trivially_copyable_v<T>, "saving to a file descriptor requires trivially copyable T, use a stream");
+
+    SnapshotHeader header = snapshot_header(buffer);
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    iovec parts[3] = {
+        {&header, sizeof(header)},
+        {const_cast<T*>(one.first), one.second * sizeof(T)},
+        {const_cast<T*>(two.first), two.second * sizeof(T)}
+    };
+
+    iovec* part = parts;
+    int count = 3;
+    while (count > 0) {
+        ssize_t written = writev(fd, part, count);
+        if (written == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+
+        size_t left = static_cast<size_t>(written);
+        while (count > 0 && left >= part->iov_len) {
+            left -= part->iov_len;
+            part++;
+            count--;
+        }
+        if (count > 0) {
+            part->iov_base = static_cast<char*>(part->iov_base) + left;
+            part->iov_len -= left;
+        }
+    }
+}
+
+inline void read_snapshot(int fd, void* to_, size_t bytes_) {
+    char* data_ = static_cast<char*>(to_);
+    while (bytes_ > 0) {
+        ssize_t count = read(fd, data_, bytes_);
+        if (count == -1) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (count == 0)
+            throw std::invalid_argument("Error: snapshot is truncated");
+
+        data_ += count;
+        bytes_ -= static_cast<size_t>(count);
+    }
+}
+
+inline uint64_t remaining_snapshot(int fd) {
+    struct stat status;
+    off_t here = lseek(fd, 0, SEEK_CUR);
+    if (here == -1 || fstat(fd, &status) == -1 || !S_ISREG(status.st_mode) || status.st_size < here)
+        return UINT64_MAX;
+
+    return static_cast<uint64_t>(status.st_size - here);
+}
+
+// Reads the header and then the elements straight into the storage of the restored buffer.
+template<class Buffer, typename = enable_if_snapshot_t<Buffer>>
+void load(Buffer& buffer, int fd) {
+    typedef typename Buffer::value_type T;
+    static_assert(std::is_trivially_copyable_v<T>, "loading from a file descriptor requires trivially copyable T, use a stream");
+
+    SnapshotHeader header;
+    read_snapshot(fd, &header, sizeof(header));
+    check_snapshot_header(header, buffer, remaining_snapshot(fd));
+
+    Buffer restored(header.capacity, buffer.get_allocator());
+    read_snapshot(fd, restored.prepare(header.size).first.first, header.size * sizeof(T));
+    restored.commit(header.size);
+    buffer = std::move(restored);
+}
+#endif
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CCIRCULAR_BUFFER_RDTSC 1
+#endif
+
+const size_t kLatencyBuckets = 64;
+
+// Stats policy for CCircularBuffer and CCircularBufferExt: CCircularBuffer<T, Allocator, Indexing, BufferStats>.
+// Only the thread that owns the buffer writes the counters, so they are bumped with a relaxed load and store
+// rather than a locked read-modify-write, and any other thread may read them with relaxed loads.
+class BufferStats {
+public:
+    struct Snapshot {
+        uint64_t pushes;
+        uint64_t pops;
+        uint64_t overwrites;
+        uint64_t drops;
+        uint64_t growths;
+        uint64_t peak_size;
+    };
+
+    void on_push(size_t, size_t count, size_t, size_t size_) {
+        add(pushes_, count);
+        if (size_ > peak_size_.load(std::memory_order_relaxed)) {
+            peak_size_.store(size_, std::memory_order_relaxed);
+        }
+    }
+
+    void on_pop(size_t, size_t count, size_t) {
+        add(pops_, count);
+    }
+
+    void on_overwrite(size_t, size_t count, size_t) {
+        add(overwrites_, count);
+    }
+
+    void on_drop(size_t count) {
+        add(drops_, count);
+    }
+
+    void on_grow(size_t) {
+        add(growths_, 1);
+    }
+
+    void on_relocate(size_t) noexcept {}
+
+    // Elements stored by push, emplace, insert, assign, push_back_n and commit.
+    uint64_t pushes() const {
+        return pushes_.load(std::memory_order_relaxed);
+    }
+
+    // Elements removed by pop, pop_front_n, consume and erase.
+    uint64_t pops() const {
+        return pops_.load(std::memory_order_relaxed);
+    }
+
+    // Stored elements evicted by a push into a full CCircularBuffer. Elements replaced by assign are not counted.
+    uint64_t overwrites() const {
+        return overwrites_.load(std::memory_order_relaxed);
+    }
+
+    // Elements of a single push_back_n, insert or assign that did not fit into CCircularBuffer at all.
+    uint64_t drops() const {
+        return drops_.load(std::memory_order_relaxed);
+    }
+
+    // Storage reallocations of CCircularBufferExt caused by growth.
+    uint64_t growths() const {
+        return growths_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t peak_size() const {
+        return peak_size_.load(std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        return {pushes(), pops(), overwrites(), drops(), growths(), peak_size()};
+    }
+protected:
+    static void add(std::atomic<uint64_t>& counter, uint64_t count) {
+        counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+private:
+    std::atomic<uint64_t> pushes_{0};
+    std::atomic<uint64_t> pops_{0};
+    std::atomic<uint64_t> overwrites_{0};
+    std::atomic<uint64_t> drops_{0};
+    std::atomic<uint64_t> growths_{0};
+    std::atomic<uint64_t> peak_size_{0};
+};
+
+// BufferStats plus a histogram of how long popped elements spent in the buffer, in timestamp counter ticks
+// (rdtsc on x86, steady_clock nanoseconds elsewhere). Bucket i counts stays of [2^i, 2^(i+1)) ticks.
+// Push times are kept per storage slot: an element shifted to another slot by a middle insert or erase is
+// measured against the slot it ends up in, and elements stored before their storage was reallocated,
+// linearized or exchanged by swap or a move are not measured.
+class LatencyStats : public BufferStats {
+public:
+    static uint64_t now() {
+#ifdef CCIRCULAR_BUFFER_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    void on_push(size_t slot, size_t count, size_t storage, size_t size_) {
+        BufferStats::on_push(slot, count, storage, size_);
+        fit(storage);
+        uint64_t stamp = now();
+        for (size_t i = 0; i < count; ++i) {
+            stamps[wrap(slot + i)] = stamp;
+        }
+    }
+
+    void on_pop(size_t slot, size_t count, size_t storage) {
+        BufferStats::on_pop(slot, count, storage);
+        fit(storage);
+        uint64_t stamp = now();
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t& pushed = stamps[wrap(slot + i)];
+            if (pushed != 0) {
+                record(stamp - pushed);
+                pushed = 0;
+            }
+        }
+    }
+
+    void on_overwrite(size_t slot, size_t count, size_t storage) {
+        BufferStats::on_overwrite(slot, count, storage);
+        fit(storage);
+        for (size_t i = 0; i < count; ++i) {
+            stamps[wrap(slot + i)] = 0;
+        }
+    }
+
+    void on_relocate(size_t) noexcept {
+        std::fill(stamps.begin(), stamps.end(), 0);
+    }
+
+    std::array<uint64_t, kLatencyBuckets> latency_histogram() const {
+        std::array<uint64_t, kLatencyBuckets> result;
+        for (size_t i = 0; i < kLatencyBuckets; ++i) {
+            result[i] = histogram_[i].load(std::memory_order_relaxed);
+        }
+
+        return result;
+    }
+private:
+    std::vector<uint64_t> stamps;
+    std::array<std::atomic<uint64_t>, kLatencyBuckets> histogram_{};
+
+    size_t wrap(size_t idx) const {
+        return idx >= stamps.size() ? idx - stamps.size() : idx;
+    }
+
+    void fit(size_t storage) {
+        if (stamps.size() != storage) {
+            stamps.assign(storage, 0);
+        }
+    }
+
+    void record(uint64_t ticks) {
+        size_t bucket = ticks == 0 ? 0 : 63 - __builtin_clzll(ticks);
+        add(histogram_[bucket], 1);
+    }
+};
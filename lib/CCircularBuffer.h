@@ -2,269 +2,960 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <iterator>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
+#include <version>
+
+#ifdef __cpp_lib_span
+#include <span>
+#endif
 
 const size_t kDefaultCapacity = 100;
+const double kDefaultGrowthFactor = 2.0;
 
-template<typename T, class Allocator = std::allocator<T>>
+struct ModuloIndexing {
+    static size_t storage_size(size_t _capacity_) {
+        return _capacity_ + 1;
+    }
+
+    static size_t grown_size(size_t storage_, double factor) {
+        return storage_ == 0 ? 2 : static_cast<size_t>(storage_ * factor) + 1;
+    }
+
+    static size_t wrap(size_t idx, size_t storage_) {
+        return idx % storage_;
+    }
+};
+
+// Stats policy that records nothing, the default. Counting policies live in BufferStats.h. Hooks get
+// physical slots of the storage, so a policy can keep data per slot. on_relocate is called whenever
+// elements moved to other slots or the storage was exchanged (reserve, growth, linearize, swap, moves).
+struct NoStats {
+    void on_push(size_t, size_t, size_t, size_t) {}
+    void on_pop(size_t, size_t, size_t) {}
+    void on_overwrite(size_t, size_t, size_t) {}
+    void on_drop(size_t) {}
+    void on_grow(size_t) {}
+    void on_relocate(size_t) noexcept {}
+};
+
+struct Pow2Indexing {
+    static size_t storage_size(size_t _capacity_) {
+        size_t storage_ = 1;
+        while (storage_ < _capacity_ + 1) {
+            storage_ <<= 1;
+        }
+
+        return storage_;
+    }
+
+    // Small factors round back to the current power of two, so the storage is at least doubled.
+    static size_t grown_size(size_t storage_, double factor) {
+        return storage_ == 0 ? 2 : storage_size(std::max(static_cast<size_t>(storage_ * factor), storage_ + 1) - 1);
+    }
+
+    static size_t wrap(size_t idx, size_t storage_) {
+        return idx & (storage_ - 1);
+    }
+};
+
+// Allocators that can grow a block in place provide reallocate(storage, count, new_count) with the semantics
+// of std::realloc and opt in by specializing is_reallocatable_allocator. CCircularBufferExt of trivially
+// copyable T then grows its storage with reallocate instead of allocating a new block and copying.
+template<class Allocator>
+struct is_reallocatable_allocator : std::false_type {};
+
+// Allocator on top of malloc, realloc and free, for CCircularBufferExt<T, ReallocAllocator<T>>.
+template<typename T>
+struct ReallocAllocator {
+    typedef T value_type;
+    typedef std::true_type is_always_equal;
+
+    ReallocAllocator() = default;
+
+    template<typename U>
+    ReallocAllocator(const ReallocAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        T* storage_ = static_cast<T*>(std::malloc(count * sizeof(T)));
+        if (storage_ == nullptr)
+            throw std::bad_alloc();
+
+        return storage_;
+    }
+
+    T* reallocate(T* storage_, size_t, size_t new_count) {
+        T* temp = static_cast<T*>(std::realloc(storage_, new_count * sizeof(T)));
+        if (temp == nullptr)
+            throw std::bad_alloc();
+
+        return temp;
+    }
+
+    void deallocate(T* storage_, size_t) {
+        std::free(storage_);
+    }
+
+    template<typename U>
+    bool operator==(const ReallocAllocator<U>&) const {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const ReallocAllocator<U>&) const {
+        return false;
+    }
+};
+
+template<typename T>
+struct is_reallocatable_allocator<ReallocAllocator<T>> : std::true_type {};
+
+template<typename T>
+struct ElementRange {
+    static void copy_construct(const T* from_, size_t count, T* to_) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count > 0) {
+                std::memcpy(static_cast<void*>(to_), from_, count * sizeof(T));
+            }
+        } else {
+            std::uninitialized_copy_n(from_, count, to_);
+        }
+    }
+
+    static void copy_assign(const T* from_, size_t count, T* to_) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count > 0) {
+                std::memcpy(static_cast<void*>(to_), from_, count * sizeof(T));
+            }
+        } else {
+            std::copy_n(from_, count, to_);
+        }
+    }
+
+    static void move_assign(T* from_, size_t count, T* to_) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count > 0) {
+                std::memcpy(static_cast<void*>(to_), from_, count * sizeof(T));
+            }
+        } else {
+            std::move(from_, from_ + count, to_);
+        }
+    }
+
+    static void move_overlapping(T* from_, size_t count, T* to_) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count > 0) {
+                std::memmove(static_cast<void*>(to_), from_, count * sizeof(T));
+            }
+        } else if (to_ < from_) {
+            std::move(from_, from_ + count, to_);
+        } else {
+            std::move_backward(from_, from_ + count, to_ + count);
+        }
+    }
+};
+
+template<typename T, typename U>
+bool equal_segments(std::pair<std::pair<T*, size_t>, std::pair<T*, size_t>> lhs,
+                    std::pair<std::pair<U*, size_t>, std::pair<U*, size_t>> rhs) {
+    std::pair<T*, size_t> left[] = {lhs.first, lhs.second};
+    std::pair<U*, size_t> right[] = {rhs.first, rhs.second};
+    size_t l = 0;
+    size_t r = 0;
+    size_t l_offset = 0;
+    size_t r_offset = 0;
+
+    while (l < 2 && r < 2) {
+        size_t count = std::min(left[l].second - l_offset, right[r].second - r_offset);
+        if (!std::equal(left[l].first + l_offset, left[l].first + l_offset + count, right[r].first + r_offset)) {
+            return false;
+        }
+        l_offset += count;
+        r_offset += count;
+        if (l_offset == left[l].second) {
+            ++l;
+            l_offset = 0;
+        }
+        if (r_offset == right[r].second) {
+            ++r;
+            r_offset = 0;
+        }
+    }
+
+    return true;
+}
+
+template<typename T, bool IsConst>
+class CCircularBufferIterator {
+    template<typename, bool> friend class CCircularBufferIterator;
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+private:
+    pointer elements_it = nullptr;
+    pointer current_it = nullptr;
+    size_t size_it = 0;
+    size_t begin_it = 0;
+
+    size_t position() const {
+        return static_cast<size_t>(current_it - elements_it);
+    }
+
+    size_t index() const {
+        size_t pos = position();
+
+        return pos >= begin_it ? pos - begin_it : pos + size_it - begin_it;
+    }
+public:
+    CCircularBufferIterator() = default;
+
+    explicit CCircularBufferIterator(pointer _elements_, size_t _size_, size_t _index_, size_t _begin_) {
+        elements_it = _elements_;
+        size_it = _size_;
+        begin_it = _begin_;
+
+        size_t pos = _begin_ + _index_;
+        if (pos >= _size_) {
+            pos -= _size_;
+        }
+        current_it = _elements_ + pos;
+    }
+
+    template<bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    CCircularBufferIterator(const CCircularBufferIterator<T, OtherConst>& rhs) {
+        elements_it = rhs.elements_it;
+        current_it = rhs.current_it;
+        size_it = rhs.size_it;
+        begin_it = rhs.begin_it;
+    }
+
+    CCircularBufferIterator& operator+=(difference_type diff) {
+        size_t pos = position();
+        if (diff >= 0) {
+            pos += static_cast<size_t>(diff);
+            if (pos >= size_it) {
+                pos -= size_it;
+            }
+        } else {
+            size_t back = static_cast<size_t>(-diff);
+            pos = pos >= back ? pos - back : pos + size_it - back;
+        }
+        current_it = elements_it + pos;
+
+        return *this;
+    }
+
+    CCircularBufferIterator operator+(difference_type diff) const {
+        CCircularBufferIterator res = *this;
+        res += diff;
+
+        return res;
+    }
+
+    friend CCircularBufferIterator operator+(difference_type diff, const CCircularBufferIterator& it) {
+        return it + diff;
+    }
+
+    CCircularBufferIterator& operator++() {
+        if (++current_it == elements_it + size_it) {
+            current_it = elements_it;
+        }
+
+        return *this;
+    }
+
+    CCircularBufferIterator operator++(int) {
+        CCircularBufferIterator res = *this;
+        ++*this;
+
+        return res;
+    }
+
+    CCircularBufferIterator& operator-=(difference_type diff) {
+        return *this += -diff;
+    }
+
+    CCircularBufferIterator operator-(difference_type diff) const {
+        CCircularBufferIterator res_ = *this;
+        res_ -= diff;
+
+        return res_;
+    }
+
+    difference_type operator-(const CCircularBufferIterator& diff) const {
+        return static_cast<difference_type>(index()) - static_cast<difference_type>(diff.index());
+    }
+
+    CCircularBufferIterator& operator--() {
+        if (current_it == elements_it) {
+            current_it += size_it;
+        }
+        --current_it;
+
+        return *this;
+    }
+
+    CCircularBufferIterator operator--(int) {
+        CCircularBufferIterator res = *this;
+        --*this;
+
+        return res;
+    }
+
+    reference operator*() const {
+        return *current_it;
+    }
+
+    pointer operator->() const {
+        return current_it;
+    }
+
+    reference operator[](difference_type diff) const {
+        return *(*this + diff);
+    }
+
+    bool operator==(const CCircularBufferIterator& rhs) const {
+        return current_it == rhs.current_it;
+    }
+
+    bool operator!=(const CCircularBufferIterator& rhs) const {
+        return current_it != rhs.current_it;
+    }
+
+    bool operator<(const CCircularBufferIterator& rhs) const {
+        return index() < rhs.index();
+    }
+
+    bool operator>(const CCircularBufferIterator& rhs) const {
+        return index() > rhs.index();
+    }
+
+    bool operator<=(const CCircularBufferIterator& rhs) const {
+        return index() <= rhs.index();
+    }
+
+    bool operator>=(const CCircularBufferIterator& rhs) const {
+        return index() >= rhs.index();
+    }
+};
+
+#ifdef __cpp_lib_concepts
+static_assert(std::random_access_iterator<CCircularBufferIterator<int, false>>);
+static_assert(std::random_access_iterator<CCircularBufferIterator<int, true>>);
+#endif
+
+template<typename T, class Allocator = std::allocator<T>, class Indexing = ModuloIndexing, class Stats = NoStats>
 class CCircularBuffer {
 private:
     T* elements = nullptr;
     Allocator allocator;
+    Stats stats_;
     size_t size_ = 0;
     size_t capacity_ = 0;
     size_t begin_ = 0;
     size_t end_ = 0;
-public:
-    typedef T                   value_type;
-    typedef value_type&         reference;
-    typedef const value_type&   const_reference;
-    typedef value_type*         iterator;
-    typedef const value_type*   const_iterator;
-    typedef size_t              size_type;
-    typedef ptrdiff_t           difference_type;
 
-    class Iterator {
-        private:
-            T* elements_it = nullptr;
-            size_t size_it;
-            size_t index_it;
-            size_t begin_it;
-        public:
-            using iterator_category = std::random_access_iterator_tag;
-            using value_type = T;
-            using difference_type = std::ptrdiff_t;
-            using pointer = T*;
-            using iterator = pointer;
-            using reference = T&;
+    typedef std::allocator_traits<Allocator> alloc_traits;
 
-            explicit Iterator(T* _elements_, size_t _size_, size_t _index_, size_t _begin_) {
-                elements_it = _elements_;
-                size_it = _size_;
-                index_it = _index_;
-                begin_it = _begin_;
-            }
-
-            Iterator(const Iterator& rhs) {
-                elements_it = rhs.elements_it;
-                size_it = rhs.size_it;
-                index_it = rhs.index_it;
-                begin_it = rhs.begin_it;
-            }
+    static constexpr bool kMoveAssignNoexcept = alloc_traits::propagate_on_container_move_assignment::value ||
+                                                alloc_traits::is_always_equal::value;
 
-            Iterator& operator+=(difference_type diff) {
-                index_it += diff;
+    template<bool Move>
+    void construct_from(const CCircularBuffer& rhs) {
+        capacity_ = rhs.capacity_;
+        elements = alloc_traits::allocate(allocator, capacity_);
+        size_ = rhs.size_;
+        begin_ = rhs.begin_;
+        end_ = rhs.end_;
 
-                return *this;
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            for_segments(begin_, size_, [this, &rhs](T* to_, size_t, size_t n) {
+                ElementRange<T>::copy_construct(rhs.elements + (to_ - elements), n, to_);
+            });
+        } else {
+            for (size_t i = 0; i < size_; ++i) {
+                if constexpr (Move) {
+                    alloc_traits::construct(allocator, &elements[wrap(begin_ + i)], std::move(rhs.elements[wrap(begin_ + i)]));
+                } else {
+                    alloc_traits::construct(allocator, &elements[wrap(begin_ + i)], rhs.elements[wrap(begin_ + i)]);
+                }
             }
+        }
+    }
 
-            Iterator operator+(difference_type diff) const {
-                Iterator res = *this;
-                res += diff;
-
-                return res;
+    // Moves count live elements from logical position from_ to to_ (the ranges may overlap),
+    // one contiguous run at a time so that trivially copyable T goes through memmove.
+    void move_range(size_t from_, size_t to_, size_t count) {
+        if (to_ < from_) {
+            while (count > 0) {
+                size_t source = wrap(begin_ + from_);
+                size_t target = wrap(begin_ + to_);
+                size_t run = std::min({count, capacity_ - source, capacity_ - target});
+                ElementRange<T>::move_overlapping(elements + source, run, elements + target);
+                from_ += run;
+                to_ += run;
+                count -= run;
+            }
+        } else if (to_ > from_) {
+            while (count > 0) {
+                size_t source = wrap(begin_ + from_ + count - 1) + 1;
+                size_t target = wrap(begin_ + to_ + count - 1) + 1;
+                size_t run = std::min({count, source, target});
+                ElementRange<T>::move_overlapping(elements + source - run, run, elements + target - run);
+                count -= run;
             }
+        }
+    }
 
-            Iterator& operator++() {
-                index_it++;
+    void destroy_range(size_t pos, size_t count) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for_segments(pos, count, [this](T* from_, size_t, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    alloc_traits::destroy(allocator, from_ + i);
+                }
+            });
+        }
+    }
 
-                return *this;
+    void relocate(size_t new_capacity_) {
+        T* temp = alloc_traits::allocate(allocator, new_capacity_);
+        size_t i = 0;
+        try {
+            for (; i < size_; ++i) {
+                alloc_traits::construct(allocator, temp + i, std::move_if_noexcept(elements[wrap(begin_ + i)]));
+            }
+        } catch (...) {
+            for (size_t j = 0; j < i; ++j) {
+                alloc_traits::destroy(allocator, temp + j);
             }
+            alloc_traits::deallocate(allocator, temp, new_capacity_);
+            throw;
+        }
+        destroy_range(begin_, size_);
+        if (elements != nullptr) {
+            alloc_traits::deallocate(allocator, elements, capacity_);
+        }
 
-            Iterator& operator-=(difference_type diff) {
-                index_it -= diff;
+        elements = temp;
+        capacity_ = new_capacity_;
+        begin_ = 0;
+        end_ = wrap(size_);
+        stats_.on_relocate(capacity_);
+    }
 
-                return *this;
+    // A moved-from buffer keeps its capacity but gives its storage away, it is allocated again
+    // by the first operation that stores elements.
+    void ensure_storage() {
+        if (elements == nullptr) {
+            elements = alloc_traits::allocate(allocator, capacity_);
+        }
+    }
+
+    // Shifts whichever side of idx_ is shorter to open count slots at logical position idx_ and fills them
+    // from source(i). Slots that were raw storage are constructed, slots of moved-from elements are assigned.
+    // The caller guarantees size_ + count < capacity_.
+    template<class Source>
+    void insert_gap(size_t idx_, size_t count, Source source) {
+        ensure_storage();
+        size_t tail = size_ - idx_;
+        if (idx_ < tail) {
+            begin_ = wrap(begin_ + capacity_ - count);
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                move_range(count, 0, idx_);
+            } else {
+                for (size_t j = 0; j < idx_; ++j) {
+                    T* to_ = &elements[wrap(begin_ + j)];
+                    T& from_ = elements[wrap(begin_ + j + count)];
+                    if (j < count) {
+                        alloc_traits::construct(allocator, to_, std::move(from_));
+                    } else {
+                        *to_ = std::move(from_);
+                    }
+                }
+            }
+            for (size_t i = 0; i < count; ++i) {
+                T* to_ = &elements[wrap(begin_ + idx_ + i)];
+                if (idx_ + i < count) {
+                    alloc_traits::construct(allocator, to_, source(i));
+                } else {
+                    *to_ = source(i);
+                }
+            }
+        } else {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                move_range(idx_, idx_ + count, tail);
+            } else {
+                for (size_t j = size_; j-- > idx_;) {
+                    T* to_ = &elements[wrap(begin_ + j + count)];
+                    T& from_ = elements[wrap(begin_ + j)];
+                    if (j + count >= size_) {
+                        alloc_traits::construct(allocator, to_, std::move(from_));
+                    } else {
+                        *to_ = std::move(from_);
+                    }
+                }
+            }
+            for (size_t i = 0; i < count; ++i) {
+                T* to_ = &elements[wrap(begin_ + idx_ + i)];
+                if (idx_ + i >= size_) {
+                    alloc_traits::construct(allocator, to_, source(i));
+                } else {
+                    *to_ = source(i);
+                }
             }
+            end_ = wrap(end_ + count);
+        }
+        size_ += count;
+        stats_.on_push(wrap(begin_ + idx_), count, capacity_, size_);
+    }
 
-            Iterator operator-(difference_type diff) const {
-                Iterator res_ = *this;
-                res_ -= diff;
+    // Closes count elements starting at logical position first_ by shifting the shorter side.
+    void erase_gap(size_t first_, size_t count) {
+        if (first_ + count > size_)
+            throw std::out_of_range("Error: index is out of range");
 
-                return res_;
-            }
+        stats_.on_pop(wrap(begin_ + first_), count, capacity_);
+        if (first_ < size_ - first_ - count) {
+            move_range(0, count, first_);
+            destroy_range(begin_, count);
+            begin_ = wrap(begin_ + count);
+        } else {
+            move_range(first_ + count, first_, size_ - first_ - count);
+            destroy_range(wrap(begin_ + size_ - count), count);
+            end_ = wrap(end_ + capacity_ - count);
+        }
+        size_ -= count;
+    }
 
-            difference_type operator-(const Iterator& diff) const {
-                return index_it - diff.index_it;
-            }
+    // Evicts elements from the back, as a push into a full buffer would, until count more elements fit.
+    // Returns how many of them can be inserted and clamps idx_ to the remaining size.
+    size_t make_room(size_t& idx_, size_t count) {
+        if (count > capacity_ - 1) {
+            stats_.on_drop(count - (capacity_ - 1));
+            count = capacity_ - 1;
+        }
+        size_t free_ = capacity_ - 1 - size_;
+        if (count > free_) {
+            size_t evicted = count - free_;
+            stats_.on_overwrite(wrap(begin_ + size_ - evicted), evicted, capacity_);
+            destroy_range(wrap(begin_ + size_ - evicted), evicted);
+            end_ = wrap(end_ + capacity_ - evicted);
+            size_ -= evicted;
+            idx_ = std::min(idx_, size_);
+        }
 
-            Iterator& operator--() {
-                index_it--;
+        return count;
+    }
 
-                return *this;
+    // Makes the count elements starting at logical position offset equal to source(i), one contiguous run
+    // at a time: live slots are assigned and the rest are constructed past the back. A pointer source (passed
+    // only for trivially copyable T) is copied with ElementRange. The caller guarantees offset <= size_
+    // and offset + count < capacity_.
+    template<class Source>
+    void assign_runs(size_t offset, size_t count, Source source) {
+        ensure_storage();
+        size_t live = std::min(count, size_ - offset);
+        for_segments(wrap(begin_ + offset), live, [&source](T* to_, size_t done, size_t n) {
+            if constexpr (std::is_pointer_v<Source>) {
+                ElementRange<T>::copy_assign(source + done, n, to_);
+            } else {
+                for (size_t i = 0; i < n; ++i) {
+                    to_[i] = source(done + i);
+                }
             }
+        });
+        try {
+            for_segments(wrap(begin_ + size_), count - live, [this, &source, live](T* to_, size_t done, size_t n) {
+                if constexpr (std::is_pointer_v<Source>) {
+                    ElementRange<T>::copy_construct(source + live + done, n, to_);
+                    size_ += n;
+                } else {
+                    for (size_t i = 0; i < n; ++i) {
+                        alloc_traits::construct(allocator, to_ + i, source(live + done + i));
+                        size_++;
+                    }
+                }
+            });
+        } catch (...) {
+            end_ = wrap(begin_ + size_);
+            throw;
+        }
+        end_ = wrap(begin_ + size_);
+        stats_.on_push(wrap(begin_ + offset), count, capacity_, size_);
+    }
 
-            reference operator*() {
-                return elements_it[(begin_it + index_it) % size_it];
-            }
+    template<class ForwardIt>
+    void assign_range(size_t offset, ForwardIt first_, size_t count) {
+        if constexpr (std::is_pointer_v<ForwardIt> && std::is_trivially_copyable_v<T> &&
+                      std::is_same_v<std::remove_cv_t<std::remove_pointer_t<ForwardIt>>, T>) {
+            assign_runs(offset, count, static_cast<const T*>(first_));
+        } else {
+            assign_runs(offset, count, [&first_](size_t) -> decltype(auto) { return *first_++; });
+        }
+    }
 
-            pointer operator->() {
-                return elements_it + (begin_it + index_it) % size_it;
+    template<bool Move>
+    void assign_from(const CCircularBuffer& val_) {
+        size_t skip = val_.size_ - std::min(val_.size_, capacity_ - 1);
+        stats_.on_drop(skip);
+        size_t offset = 0;
+        val_.for_segments(val_.wrap(val_.begin_ + skip), val_.size_ - skip, [this, &offset](T* from_, size_t, size_t n) {
+            if constexpr (Move && !std::is_trivially_copyable_v<T>) {
+                assign_range(offset, std::make_move_iterator(from_), n);
+            } else {
+                assign_range(offset, static_cast<const T*>(from_), n);
             }
+            offset += n;
+        });
+    }
 
-            bool operator==(const Iterator& rhs) const {
-                return index_it == rhs.index_it;
-            }
+    void swap_storage(CCircularBuffer& rhs) noexcept {
+        std::swap(elements, rhs.elements);
+        std::swap(size_, rhs.size_);
+        std::swap(capacity_, rhs.capacity_);
+        std::swap(begin_, rhs.begin_);
+        std::swap(end_, rhs.end_);
+        stats_.on_relocate(capacity_);
+        rhs.stats_.on_relocate(rhs.capacity_);
+    }
 
-            bool operator!=(const Iterator& rhs) const {
-                return index_it != rhs.index_it;
-            }
+    size_t wrap(size_t idx) const {
+        return Indexing::wrap(idx, capacity_);
+    }
 
-            bool operator<(const Iterator& rhs) const {
-                return index_it < rhs.index_it;
-            }
+    std::pair<std::pair<T*, size_t>, std::pair<T*, size_t>> segments(size_t pos, size_t count) const {
+        size_t first = std::min(count, capacity_ - pos);
 
-            bool operator>(const Iterator& rhs) const {
-                return index_it > rhs.index_it;
-            }
-    };
+        return {{elements + pos, first}, {elements, count - first}};
+    }
 
-    explicit CCircularBuffer(size_t _capacity_) {
-        elements = allocator.allocate(_capacity_ + 1);
-        capacity_ = _capacity_ + 1;
+    template<class Operation>
+    void for_segments(size_t pos, size_t count, Operation operation) const {
+        size_t first = std::min(count, capacity_ - pos);
+        operation(elements + pos, 0, first);
+        if (count > first) {
+            operation(elements, first, count - first);
+        }
+    }
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+    typedef Allocator           allocator_type;
+    typedef std::pair<T*, size_t> array_range;
+    typedef std::pair<array_range, array_range> array_range_pair;
+
+    typedef CCircularBufferIterator<T, false>       Iterator;
+    typedef CCircularBufferIterator<T, true>        ConstIterator;
+    typedef Iterator                                iterator;
+    typedef ConstIterator                           const_iterator;
+    typedef std::reverse_iterator<Iterator>         reverse_iterator;
+    typedef std::reverse_iterator<ConstIterator>    const_reverse_iterator;
+
+    explicit CCircularBuffer(size_t _capacity_, const Allocator& allocator_ = Allocator()) : allocator(allocator_) {
+        capacity_ = Indexing::storage_size(_capacity_);
+        elements = alloc_traits::allocate(allocator, capacity_);
         size_ = 0;
         begin_ = 0;
         end_ = 0;
     }
 
-    CCircularBuffer(size_t t, const_reference val_) {
-        elements = allocator.allocate(t + 1);
-        capacity_ = t + 1;
-        size_ = 0;
-        begin_ = 0;
-        end_ = 0;
-        for (auto i = 0; i < t; ++i) {
+    CCircularBuffer(size_t t, const_reference val_, const Allocator& allocator_ = Allocator())
+        : CCircularBuffer(t, allocator_) {
+        for (size_t i = 0; i < t; ++i) {
             push_back(val_);
         }
     }
 
-    CCircularBuffer(std::initializer_list<T> list) {
-        elements = allocator.allocate(list.size() + 1);
-        capacity_ = list.size() + 1;
-        size_ = 0;
-        begin_ = 0;
-        end_ = 0;
+    CCircularBuffer(std::initializer_list<T> list, const Allocator& allocator_ = Allocator())
+        : CCircularBuffer(list.size(), allocator_) {
         for (auto c : list) {
             push_back(c);
         }
     }
 
-    CCircularBuffer(const CCircularBuffer& rhs) {
-        capacity_ = rhs.capacity_;
-        elements = allocator.allocate(rhs.capacity_);
-        size_ = rhs.size_;
-        begin_ = rhs.begin_;
-        end_ = rhs.end_;
-        
-        for (size_t i = 0; i < size_; ++i) {
-            elements[i] = rhs.elements[i];
-        }
+    CCircularBuffer(const CCircularBuffer& rhs)
+        : CCircularBuffer(rhs, alloc_traits::select_on_container_copy_construction(rhs.allocator)) {}
+
+    CCircularBuffer(const CCircularBuffer& rhs, const Allocator& allocator_) : allocator(allocator_) {
+        construct_from<false>(rhs);
     }
-    
-    CCircularBuffer() {
-        capacity_ = kDefaultCapacity;
-        elements = allocator.allocate(capacity_);
-        size_ = 0;
-        begin_ = 0;
-        end_ = 0;
+
+    CCircularBuffer(CCircularBuffer&& rhs) noexcept : allocator(std::move(rhs.allocator)) {
+        swap_storage(rhs);
+        rhs.capacity_ = capacity_;
+    }
+
+    CCircularBuffer(CCircularBuffer&& rhs, const Allocator& allocator_) : allocator(allocator_) {
+        if (allocator == rhs.allocator) {
+            swap_storage(rhs);
+            rhs.capacity_ = capacity_;
+        } else {
+            construct_from<true>(rhs);
+        }
     }
 
+    explicit CCircularBuffer(const Allocator& allocator_) : CCircularBuffer(kDefaultCapacity - 1, allocator_) {}
+
+    CCircularBuffer() : CCircularBuffer(Allocator()) {}
+
     ~CCircularBuffer() {
-        allocator.deallocate(elements, capacity_);
+        if (elements != nullptr) {
+            destroy_range(begin_, size_);
+            alloc_traits::deallocate(allocator, elements, capacity_);
+        }
     }
 
-    size_t capacity() {
+    allocator_type get_allocator() const {
+        return allocator;
+    }
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+    size_t capacity() const {
         return capacity_;
     }
 
+    // Largest capacity whose storage, rounded up by Indexing, the allocator can still provide.
+    size_t max_size() const {
+        return alloc_traits::max_size(allocator) / 2 - 1;
+    }
+
     void clear() {
+        destroy_range(begin_, size_);
         size_ = 0;
         begin_ = 0;
         end_ = 0;
-        allocator.deallocate(elements, capacity_);
     }
 
-    bool empty() {
+    bool empty() const {
         return begin_ == end_;
     }
 
-    size_t size() {
+    size_t size() const {
         return size_;
     }
     
     CCircularBuffer& operator=(const std::initializer_list<T>& list) {
-        clear();
-        elements = allocator.allocate(list.size() + 1);
-        capacity_ = list.size() + 1;
-        size_ = 0;
-        begin_ = 0;
-        end_ = 0;
-        for (auto c : list) {
-            push_back(c);
-        }
+        CCircularBuffer copy(list, allocator);
+        swap_storage(copy);
+
+        return *this;
     }
 
     CCircularBuffer& operator=(const CCircularBuffer& rhs) {
-        clear();
-        capacity_ = rhs.capacity_;
-        elements = allocator.allocate(rhs.size_);
-        size_ = rhs.size_;
-        begin_ = rhs.begin_;
-        end_ = rhs.end_;
+        if (this != &rhs) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                CCircularBuffer copy(rhs, rhs.allocator);
+                swap_storage(copy);
+                std::swap(allocator, copy.allocator);
+            } else {
+                CCircularBuffer copy(rhs, allocator);
+                swap_storage(copy);
+            }
+        }
+
+        return *this;
+    }
 
-        for (size_t i = 0; i < size_; ++i) {
-            *elements[i] = rhs.elements[i];
+    CCircularBuffer& operator=(CCircularBuffer&& rhs) noexcept(kMoveAssignNoexcept) {
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            CCircularBuffer moved(std::move(rhs));
+            swap_storage(moved);
+            std::swap(allocator, moved.allocator);
+        } else {
+            CCircularBuffer moved(std::move(rhs), allocator);
+            swap_storage(moved);
         }
 
         return *this;
     }
 
+    void swap(CCircularBuffer& rhs) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            std::swap(allocator, rhs.allocator);
+        }
+        swap_storage(rhs);
+    }
+
     T& operator[](size_t idx) const {
         if (size_ == 0)
             throw std::out_of_range("Empty buffer");
         if (idx >= size_)
             throw std::out_of_range("Error: index is out of range"); 
         
-        return elements[((idx % size_) + begin_) % capacity_];
+        return elements[wrap(begin_ + idx)];
     }
 
     Iterator push_front(const_reference element_) {
-        begin_ = (begin_ - 1 + capacity_) % capacity_;
-        allocator.construct(&elements[begin_], element_);
+        return emplace_front(element_);
+    }
+
+    Iterator push_front(T&& element_) {
+        return emplace_front(std::move(element_));
+    }
+
+    template<typename... Args>
+    Iterator emplace_front(Args&&... args) {
+        ensure_storage();
+        size_t pos = wrap(begin_ - 1 + capacity_);
+        alloc_traits::construct(allocator, &elements[pos], std::forward<Args>(args)...);
+        begin_ = pos;
 
         if (size_ + 1 == capacity_) {
-            end_ = (end_ + capacity_ - 1) % capacity_;
+            end_ = wrap(end_ + capacity_ - 1);
+            stats_.on_overwrite(end_, 1, capacity_);
+            alloc_traits::destroy(allocator, &elements[end_]);
         } else {
             size_++;
         }
+        stats_.on_push(pos, 1, capacity_, size_);
 
         return begin();
     }
 
     Iterator push_back(const_reference element_) {
-        allocator.construct(&elements[end_], element_);
-        end_ = (end_ + 1) % capacity_;
+        return emplace_back(element_);
+    }
+
+    Iterator push_back(T&& element_) {
+        return emplace_back(std::move(element_));
+    }
+
+    template<typename... Args>
+    Iterator emplace_back(Args&&... args) {
+        ensure_storage();
+        alloc_traits::construct(allocator, &elements[end_], std::forward<Args>(args)...);
+        size_t pos = end_;
+        end_ = wrap(end_ + 1);
 
-        if (size_ + 1 == capacity_)
-            begin_ = (begin_ + 1) % capacity_;
-        else
+        if (size_ + 1 == capacity_) {
+            stats_.on_overwrite(begin_, 1, capacity_);
+            alloc_traits::destroy(allocator, &elements[begin_]);
+            begin_ = wrap(begin_ + 1);
+        } else {
             size_++;
+        }
+        stats_.on_push(pos, 1, capacity_, size_);
 
         return end();
     }
 
+    void push_back_n(const T* from_, size_t count) {
+        ensure_storage();
+        size_t usable = capacity_ - 1;
+        if (count > usable) {
+            stats_.on_drop(count - usable);
+            from_ += count - usable;
+            count = usable;
+        }
+        if (size_ + count > usable) {
+            stats_.on_overwrite(begin_, size_ + count - usable, capacity_);
+        }
+
+        size_t pos = end_;
+        size_t raw = std::min(count, capacity_ - size_);
+        for_segments(end_, raw, [from_](T* to_, size_t offset, size_t n) {
+            ElementRange<T>::copy_construct(from_ + offset, n, to_);
+        });
+        for_segments(wrap(end_ + raw), count - raw, [from_, raw](T* to_, size_t offset, size_t n) {
+            ElementRange<T>::copy_assign(from_ + raw + offset, n, to_);
+        });
+        end_ = wrap(end_ + count);
+
+        if (size_ + count > usable) {
+            destroy_range(end_, 1);
+            begin_ = wrap(begin_ + size_ + count - usable);
+            size_ = usable;
+        } else {
+            size_ += count;
+        }
+        stats_.on_push(pos, count, capacity_, size_);
+    }
+
+    size_t pop_front_n(T* to_, size_t count) {
+        count = std::min(count, size_);
+        for_segments(begin_, count, [to_](T* from_, size_t offset, size_t n) {
+            ElementRange<T>::move_assign(from_, n, to_ + offset);
+        });
+        stats_.on_pop(begin_, count, capacity_);
+        destroy_range(begin_, count);
+        begin_ = wrap(begin_ + count);
+        size_ -= count;
+
+        return count;
+    }
+
+#ifdef __cpp_lib_span
+    void push_back_n(std::span<const T> from_) {
+        push_back_n(from_.data(), from_.size());
+    }
+
+    size_t pop_front_n(std::span<T> to_) {
+        return pop_front_n(to_.data(), to_.size());
+    }
+#endif
+
+    array_range_pair prepare(size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>, "prepare() hands out raw storage and requires trivially copyable T");
+
+        ensure_storage();
+
+        return segments(end_, std::min(count, capacity_ - 1 - size_));
+    }
+
+    void commit(size_t count) {
+        if (size_ + count >= capacity_)
+            throw std::out_of_range("Error: committing more elements than prepared");
+
+        stats_.on_push(end_, count, capacity_, size_ + count);
+        end_ = wrap(end_ + count);
+        size_ += count;
+    }
+
+    array_range_pair peek(size_t count) const {
+        return segments(begin_, std::min(count, size_));
+    }
+
+    void consume(size_t count) {
+        if (count > size_)
+            throw std::out_of_range("Error: consuming more elements than stored");
+
+        stats_.on_pop(begin_, count, capacity_);
+        destroy_range(begin_, count);
+        begin_ = wrap(begin_ + count);
+        size_ -= count;
+    }
+
     T pop_front() {
         if (size_ > 0) {
+            T element_ = std::move(elements[begin_]);
+            stats_.on_pop(begin_, 1, capacity_);
+            alloc_traits::destroy(allocator, &elements[begin_]);
             size_--;
-            begin_ = (begin_ + 1) % capacity_;
+            begin_ = wrap(begin_ + 1);
 
-            return elements[(begin_ - 1) % capacity_];
+            return element_;
         } else {
             throw std::out_of_range("Empty buffer");
         }
@@ -272,44 +963,71 @@ public:
 
     T pop_back() {
         if (size_ > 0) {
+            size_t idx_ = wrap(capacity_ + end_ - 1);
+            T element_ = std::move(elements[idx_]);
+            stats_.on_pop(idx_, 1, capacity_);
+            alloc_traits::destroy(allocator, &elements[idx_]);
             size_--;
-            end_ = (capacity_ + end_ - 1) % capacity_;
+            end_ = idx_;
 
-            return elements[(end_) % capacity_];
+            return element_;
         } else {
             throw std::out_of_range("Empty buffer");
         }
     }
 
-    void assign(const CCircularBuffer& val_) {
-        for (auto i = val_.begin(); i < val_.end(); ++i) {
-            pop_front();
+    // Replaces the first elements with the assigned ones in a single pass over the storage; elements past
+    // them are kept and the buffer grows when it held fewer. When more than fit are assigned, the last ones
+    // are kept, as pushing them one by one would do. Iterators must not point into this buffer.
+    template<class InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void assign(InputIt first_, InputIt last_) {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<InputIt>::iterator_category>) {
+            size_t count = std::distance(first_, last_);
+            if (count > capacity_ - 1) {
+                stats_.on_drop(count - (capacity_ - 1));
+                std::advance(first_, count - (capacity_ - 1));
+                count = capacity_ - 1;
+            }
+            assign_range(0, first_, count);
+        } else {
+            for (size_t i = 0; i < size_ && first_ != last_; ++i, ++first_) {
+                size_t pos = wrap(begin_ + i);
+                elements[pos] = *first_;
+                stats_.on_push(pos, 1, capacity_, size_);
+            }
+            for (; first_ != last_; ++first_) {
+                emplace_back(*first_);
+            }
         }
+    }
 
-        for (auto i = val_.begin(); i < val_.end(); ++i) {
-            push_front(val_[val_.end() - i - 1]);
-        }
+    void assign(std::initializer_list<T> list) {
+        assign(list.begin(), list.end());
     }
 
-    void assign(size_t n, const_reference val_) {
-        for (size_t i = 0; i < n; ++i) {
-            pop_front();
+    void assign(const CCircularBuffer& val_) {
+        if (this != &val_) {
+            assign_from<false>(val_);
         }
+    }
 
-        for (size_t i = 0; i < n; ++i) {
-            push_front(val_);
+    void assign(CCircularBuffer&& val_) {
+        if (this != &val_) {
+            assign_from<true>(val_);
         }
     }
 
-    void erase(size_t idx_) {
-        if (size_  + 1 == capacity_) {
-            pop_back();
-        }
-        for (size_t i = idx_; i < end_; i++) {
-            elements[i % capacity_] = elements[(i + 1) % capacity_];
+    void assign(size_t n, const_reference val_) {
+        T value_(val_);
+        if (n > capacity_ - 1) {
+            stats_.on_drop(n - (capacity_ - 1));
         }
+        assign_runs(0, std::min(n, capacity_ - 1), [&value_](size_t) -> const T& { return value_; });
+    }
 
-        end_ = (end_ - 1) % capacity_;
+    void erase(size_t idx_) {
+        erase_gap(idx_, 1);
     }
 
     void erase(const Iterator& idx) {
@@ -317,62 +1035,139 @@ public:
         erase(index);
     }
 
+    Iterator erase(Iterator first_, Iterator last_) {
+        size_t idx_ = first_ - begin();
+        erase_gap(idx_, last_ - first_);
+
+        return Iterator(elements, capacity_, idx_, begin_);
+    }
+
     Iterator insert(const_reference element_, Iterator index) {
-        if (size_  + 1 == capacity_) {
-            pop_back();
-        }
         size_t idx_ = index - begin();
+        T value_(element_);
+        make_room(idx_, 1);
+        insert_gap(idx_, 1, [&value_](size_t) -> T&& { return std::move(value_); });
 
-        for (size_t i = end_; i != idx_; --i) {
-            elements[i % capacity_] = elements[(i - 1) % capacity_];
-        }
+        return Iterator(elements, capacity_, idx_, begin_);
+    }
 
-        allocator.construct(elements[idx_], element_);
-        size_++;
-        end_ = (end_ + 1) % capacity_;
+    Iterator insert(Iterator pos, size_t times, const_reference element_) {
+        size_t idx_ = pos - begin();
+        T value_(element_);
+        times = make_room(idx_, times);
+        insert_gap(idx_, times, [&value_](size_t) -> const T& { return value_; });
 
         return Iterator(elements, capacity_, idx_, begin_);
     }
 
-    Iterator insert(Iterator pos, size_t times, const_reference element_) {
-        for (size_t i = 0; i < times; ++i) {
-            insert(element_, pos);
-        }
+    Iterator insert(Iterator pos, ConstIterator from_, ConstIterator to_) {
         size_t idx_ = pos - begin();
+        CCircularBuffer copy(to_ - from_, allocator);
+        for (auto i = from_; i != to_; ++i) {
+            copy.push_back(*i);
+        }
+        T* values = copy.array_one().first;
+        size_t count = make_room(idx_, copy.size());
+        insert_gap(idx_, count, [values](size_t i) -> T&& { return std::move(values[i]); });
+
+        return Iterator(elements, capacity_, idx_, begin_);
+    }
+
+    Iterator insert(Iterator pos, const CCircularBuffer& val) {
+        return insert(pos, val.begin(), val.end());
+    }
+
+    void reserve(size_t _capacity_) {
+        size_t new_capacity_ = Indexing::storage_size(_capacity_);
+        if (new_capacity_ > capacity_) {
+            relocate(new_capacity_);
+        }
+    }
+
+    array_range array_one() const {
+        return segments(begin_, size_).first;
+    }
+
+    array_range array_two() const {
+        return segments(begin_, size_).second;
+    }
+
+    bool is_linearized() const {
+        return begin_ + size_ <= capacity_;
+    }
+
+    T* linearize() {
+        if (is_linearized()) {
+            return elements + begin_;
+        }
+
+        size_t head = capacity_ - begin_;
+        size_t tail = size_ - head;
+        for (size_t i = 0; i < head; ++i) {
+            if (tail + i < begin_) {
+                alloc_traits::construct(allocator, &elements[tail + i], std::move(elements[begin_ + i]));
+            } else {
+                elements[tail + i] = std::move(elements[begin_ + i]);
+            }
+        }
+        for (size_t i = std::max(begin_, size_); i < capacity_; ++i) {
+            alloc_traits::destroy(allocator, &elements[i]);
+        }
+        std::rotate(elements, elements + tail, elements + size_);
+
+        begin_ = 0;
+        end_ = wrap(size_);
+        stats_.on_relocate(capacity_);
+
+        return elements;
+    }
+
+    Iterator begin() {
+        return Iterator(elements, capacity_, 0, begin_);
+    }
+
+    Iterator end() {
+        return Iterator(elements, capacity_, size_, begin_);
+    }
+
+    ConstIterator begin() const {
+        return ConstIterator(elements, capacity_, 0, begin_);
+    }
+
+    ConstIterator end() const {
+        return ConstIterator(elements, capacity_, size_, begin_);
+    }
+
+    ConstIterator cbegin() const {
+        return begin();
+    }
 
-        return Iterator(elements, capacity_, idx_, begin_);
+    ConstIterator cend() const {
+        return end();
     }
 
-    Iterator insert(Iterator pos, Iterator from_, Iterator to_) {
-        CCircularBuffer copy(from_ - to_ + 1);
-        size_t idx_;
-        for (auto i = from_; i < to_; ++i) {
-            idx_ = i - begin();
-            copy.push_back(elements[idx_]);
-        }
-        for (auto i = from_; i < to_; ++i) {
-            insert(copy[i - from_], pos);
-            pos += 1;
-        }
+    reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
 
-        return pos;
+    reverse_iterator rend() {
+        return reverse_iterator(begin());
     }
 
-    Iterator insert(Iterator pos, const CCircularBuffer& val) {
-        return insert(pos, val.begin(), val.end());
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
     }
 
-    void reserve(size_t _capacity_) {
-        capacity_ =  _capacity_ + 1;
-        elements = allocator.allocate(_capacity_ + 1);
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
     }
 
-    Iterator begin() const {
-        return Iterator(elements, capacity_, 0, begin_);
+    const_reverse_iterator crbegin() const {
+        return rbegin();
     }
 
-    Iterator end() const {
-        return Iterator(elements, capacity_, size_, begin_);
+    const_reverse_iterator crend() const {
+        return rend();
     }
 
     T& front() const {
@@ -380,11 +1175,11 @@ public:
     }
 
     T& back() const {
-        return elements[(size_ + begin_ - 1) % capacity_];
+        return elements[wrap(size_ + begin_ - 1)];
     }
 
     bool operator==(const CCircularBuffer& rhs) const {
-        return std::equal(this->begin(), this->end(), rhs.begin(), rhs.end());
+        return size_ == rhs.size_ && equal_segments(segments(begin_, size_), rhs.segments(rhs.begin_, rhs.size_));
     }
 
     bool operator!=(const CCircularBuffer& rhs) const {
@@ -392,188 +1187,481 @@ public:
     }
 };
 
-template<typename T, class Allocator = std::allocator<T>>
+template<typename T, class Allocator = std::allocator<T>, class Indexing = ModuloIndexing, class Stats = NoStats>
 class CCircularBufferExt {
 private:
     T* elements = nullptr;
     Allocator allocator;
+    Stats stats_;
     size_t size_ = 0;
     size_t capacity_ = 0;
     size_t begin_ = 0;
     size_t end_ = 0;
-public:
-    typedef T                   value_type;
-    typedef value_type&         reference;
-    typedef const value_type&   const_reference;
-    typedef value_type*         iterator;
-    typedef const value_type*   const_iterator;
-    typedef size_t              size_type;
-    typedef ptrdiff_t           difference_type;
+    double growth_factor_ = kDefaultGrowthFactor;
 
-    class Iterator {
-        private:
-            T* elements_it = nullptr;
-            size_t size_it;
-            size_t index_it;
-            size_t begin_it;
-        public:
-            using iterator_category = std::random_access_iterator_tag;
-            using value_type = T;
-            using difference_type = std::ptrdiff_t;
-            using pointer = T*;
-            using reference = T&;
+    typedef std::allocator_traits<Allocator> alloc_traits;
 
+    static constexpr bool kMoveAssignNoexcept = alloc_traits::propagate_on_container_move_assignment::value ||
+                                                alloc_traits::is_always_equal::value;
 
-            explicit Iterator(T* _elements_, size_t _size_, size_t _index_, size_t _begin_) {
-                elements_it = _elements_;
-                size_it = _size_;
-                index_it = _index_;
-                begin_it = _begin_;
-            }
+    static constexpr bool kReallocatable = std::is_trivially_copyable_v<T> &&
+                                           is_reallocatable_allocator<Allocator>::value;
 
-            Iterator(const Iterator& rhs) {
-                elements_it = rhs.elements_it;
-                size_it = rhs.size_it;
-                index_it = rhs.index_it;
-                begin_it = rhs.begin_it;
-            }
+    size_t wrap(size_t idx) const {
+        return Indexing::wrap(idx, capacity_);
+    }
 
-            Iterator& operator+=(difference_type diff) {
-                index_it += diff;
+    std::pair<std::pair<T*, size_t>, std::pair<T*, size_t>> segments(size_t pos, size_t count) const {
+        size_t first = std::min(count, capacity_ - pos);
 
-                return *this;
-            }
+        return {{elements + pos, first}, {elements, count - first}};
+    }
 
-            Iterator operator+(difference_type diff) const {
-                Iterator res = *this;
-                res += diff;
+    template<class Operation>
+    void for_segments(size_t pos, size_t count, Operation operation) const {
+        size_t first = std::min(count, capacity_ - pos);
+        operation(elements + pos, 0, first);
+        if (count > first) {
+            operation(elements, first, count - first);
+        }
+    }
 
-                return res;
-            }
+    T* allocate_storage(size_t count) {
+        return alloc_traits::allocate(allocator, count);
+    }
 
-            Iterator& operator++() {
-                index_it++;
+    void deallocate_storage(T* storage_, size_t count) {
+        if (storage_ == nullptr) {
+            return;
+        }
+        alloc_traits::deallocate(allocator, storage_, count);
+    }
 
-                return *this;
+    void relocate(size_t new_capacity_) {
+        size_t head = std::min(size_, capacity_ - begin_);
+        size_t tail = size_ - head;
+
+        if constexpr (kReallocatable) {
+            elements = elements == nullptr ? allocate_storage(new_capacity_)
+                                           : allocator.reallocate(elements, capacity_, new_capacity_);
+            if (tail > 0) {
+                if (tail <= head && tail <= new_capacity_ - capacity_) {
+                    std::memcpy(elements + capacity_, elements, tail * sizeof(T));
+                } else {
+                    size_t new_begin_ = new_capacity_ - head;
+                    std::memmove(elements + new_begin_, elements + begin_, head * sizeof(T));
+                    begin_ = new_begin_;
+                }
+            }
+            capacity_ = new_capacity_;
+            end_ = wrap(begin_ + size_);
+        } else {
+            T* temp = allocate_storage(new_capacity_);
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                ElementRange<T>::copy_construct(elements + begin_, head, temp);
+                ElementRange<T>::copy_construct(elements, tail, temp + head);
+            } else {
+                size_t i = 0;
+                try {
+                    for (; i < size_; ++i) {
+                        alloc_traits::construct(allocator, temp + i, std::move_if_noexcept(elements[wrap(begin_ + i)]));
+                    }
+                } catch (...) {
+                    for (size_t j = 0; j < i; ++j) {
+                        alloc_traits::destroy(allocator, temp + j);
+                    }
+                    deallocate_storage(temp, new_capacity_);
+                    throw;
+                }
+                for (size_t j = 0; j < size_; ++j) {
+                    alloc_traits::destroy(allocator, &elements[wrap(begin_ + j)]);
+                }
             }
+            deallocate_storage(elements, capacity_);
 
-            Iterator& operator-=(difference_type diff) {
-                index_it -= diff;
+            elements = temp;
+            capacity_ = new_capacity_;
+            begin_ = 0;
+            end_ = wrap(size_);
+        }
+        stats_.on_relocate(capacity_);
+    }
 
-                return *this;
-            }
+    // Makes room for at least required_ elements, whatever the growth factor rounds to.
+    void grow(size_t required_) {
+        size_t new_capacity_ = Indexing::grown_size(capacity_, growth_factor_);
+        if (new_capacity_ <= required_) {
+            new_capacity_ = Indexing::storage_size(required_);
+        }
+        relocate(new_capacity_);
+        stats_.on_grow(new_capacity_);
+    }
 
-            Iterator operator-(difference_type diff) const {
-                Iterator res_ = *this;
-                res_ -= diff;
+    template<bool Move>
+    void construct_from(const CCircularBufferExt& rhs) {
+        capacity_ = rhs.capacity_;
+        elements = rhs.elements == nullptr ? nullptr : allocate_storage(capacity_);
+        size_ = rhs.size_;
+        begin_ = rhs.begin_;
+        end_ = rhs.end_;
+        growth_factor_ = rhs.growth_factor_;
 
-                return res_;
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            for_segments(begin_, size_, [this, &rhs](T* to_, size_t, size_t n) {
+                ElementRange<T>::copy_construct(rhs.elements + (to_ - elements), n, to_);
+            });
+        } else {
+            for (size_t i = 0; i < size_; ++i) {
+                if constexpr (Move) {
+                    alloc_traits::construct(allocator, &elements[wrap(begin_ + i)], std::move(rhs.elements[wrap(begin_ + i)]));
+                } else {
+                    alloc_traits::construct(allocator, &elements[wrap(begin_ + i)], rhs.elements[wrap(begin_ + i)]);
+                }
             }
+        }
+    }
 
-            difference_type operator-(const Iterator& diff) const {
-                return index_it - diff.index_it;
+    // Moves count live elements from logical position from_ to to_ (the ranges may overlap),
+    // one contiguous run at a time so that trivially copyable T goes through memmove.
+    void move_range(size_t from_, size_t to_, size_t count) {
+        if (to_ < from_) {
+            while (count > 0) {
+                size_t source = wrap(begin_ + from_);
+                size_t target = wrap(begin_ + to_);
+                size_t run = std::min({count, capacity_ - source, capacity_ - target});
+                ElementRange<T>::move_overlapping(elements + source, run, elements + target);
+                from_ += run;
+                to_ += run;
+                count -= run;
             }
+        } else if (to_ > from_) {
+            while (count > 0) {
+                size_t source = wrap(begin_ + from_ + count - 1) + 1;
+                size_t target = wrap(begin_ + to_ + count - 1) + 1;
+                size_t run = std::min({count, source, target});
+                ElementRange<T>::move_overlapping(elements + source - run, run, elements + target - run);
+                count -= run;
+            }
+        }
+    }
 
-            Iterator& operator--() {
-                index_it--;
+    void destroy_range(size_t pos, size_t count) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for_segments(pos, count, [this](T* from_, size_t, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    alloc_traits::destroy(allocator, from_ + i);
+                }
+            });
+        }
+    }
 
-                return *this;
+    // Shifts whichever side of idx_ is shorter to open count slots at logical position idx_ and fills them
+    // from source(i). Slots that were raw storage are constructed, slots of moved-from elements are assigned.
+    // The caller guarantees size_ + count < capacity_.
+    template<class Source>
+    void insert_gap(size_t idx_, size_t count, Source source) {
+        size_t tail = size_ - idx_;
+        if (idx_ < tail) {
+            begin_ = wrap(begin_ + capacity_ - count);
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                move_range(count, 0, idx_);
+            } else {
+                for (size_t j = 0; j < idx_; ++j) {
+                    T* to_ = &elements[wrap(begin_ + j)];
+                    T& from_ = elements[wrap(begin_ + j + count)];
+                    if (j < count) {
+                        alloc_traits::construct(allocator, to_, std::move(from_));
+                    } else {
+                        *to_ = std::move(from_);
+                    }
+                }
             }
-
-            reference operator*() {
-                return elements_it[(begin_it + index_it) % size_it];
+            for (size_t i = 0; i < count; ++i) {
+                T* to_ = &elements[wrap(begin_ + idx_ + i)];
+                if (idx_ + i < count) {
+                    alloc_traits::construct(allocator, to_, source(i));
+                } else {
+                    *to_ = source(i);
+                }
             }
-
-            pointer operator->() {
-                return elements_it + (begin_it + index_it) % size_it;
+        } else {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                move_range(idx_, idx_ + count, tail);
+            } else {
+                for (size_t j = size_; j-- > idx_;) {
+                    T* to_ = &elements[wrap(begin_ + j + count)];
+                    T& from_ = elements[wrap(begin_ + j)];
+                    if (j + count >= size_) {
+                        alloc_traits::construct(allocator, to_, std::move(from_));
+                    } else {
+                        *to_ = std::move(from_);
+                    }
+                }
             }
-
-            bool operator==(const Iterator& rhs) const {
-                return index_it == rhs.index_it;
+            for (size_t i = 0; i < count; ++i) {
+                T* to_ = &elements[wrap(begin_ + idx_ + i)];
+                if (idx_ + i >= size_) {
+                    alloc_traits::construct(allocator, to_, source(i));
+                } else {
+                    *to_ = source(i);
+                }
             }
+            end_ = wrap(end_ + count);
+        }
+        size_ += count;
+        stats_.on_push(wrap(begin_ + idx_), count, capacity_, size_);
+    }
+
+    // Closes count elements starting at logical position first_ by shifting the shorter side.
+    void erase_gap(size_t first_, size_t count) {
+        if (first_ + count > size_)
+            throw std::out_of_range("Error: index is out of range");
+        if (count == 0)
+            return;
+
+        stats_.on_pop(wrap(begin_ + first_), count, capacity_);
+        if (first_ < size_ - first_ - count) {
+            move_range(0, count, first_);
+            destroy_range(begin_, count);
+            begin_ = wrap(begin_ + count);
+        } else {
+            move_range(first_ + count, first_, size_ - first_ - count);
+            destroy_range(wrap(begin_ + size_ - count), count);
+            end_ = wrap(end_ + capacity_ - count);
+        }
+        size_ -= count;
+    }
 
-            bool operator!=(const Iterator& rhs) const {
-                return index_it != rhs.index_it;
+    // Makes the count elements starting at logical position offset equal to source(i), one contiguous run
+    // at a time: live slots are assigned and the rest are constructed past the back. A pointer source (passed
+    // only for trivially copyable T) is copied with ElementRange. The caller guarantees offset <= size_
+    // and offset + count < capacity_.
+    template<class Source>
+    void assign_runs(size_t offset, size_t count, Source source) {
+        size_t live = std::min(count, size_ - offset);
+        for_segments(wrap(begin_ + offset), live, [&source](T* to_, size_t done, size_t n) {
+            if constexpr (std::is_pointer_v<Source>) {
+                ElementRange<T>::copy_assign(source + done, n, to_);
+            } else {
+                for (size_t i = 0; i < n; ++i) {
+                    to_[i] = source(done + i);
+                }
             }
+        });
+        try {
+            for_segments(wrap(begin_ + size_), count - live, [this, &source, live](T* to_, size_t done, size_t n) {
+                if constexpr (std::is_pointer_v<Source>) {
+                    ElementRange<T>::copy_construct(source + live + done, n, to_);
+                    size_ += n;
+                } else {
+                    for (size_t i = 0; i < n; ++i) {
+                        alloc_traits::construct(allocator, to_ + i, source(live + done + i));
+                        size_++;
+                    }
+                }
+            });
+        } catch (...) {
+            end_ = wrap(begin_ + size_);
+            throw;
+        }
+        end_ = wrap(begin_ + size_);
+        stats_.on_push(wrap(begin_ + offset), count, capacity_, size_);
+    }
+
+    template<class ForwardIt>
+    void assign_range(size_t offset, ForwardIt first_, size_t count) {
+        if constexpr (std::is_pointer_v<ForwardIt> && std::is_trivially_copyable_v<T> &&
+                      std::is_same_v<std::remove_cv_t<std::remove_pointer_t<ForwardIt>>, T>) {
+            assign_runs(offset, count, static_cast<const T*>(first_));
+        } else {
+            assign_runs(offset, count, [&first_](size_t) -> decltype(auto) { return *first_++; });
+        }
+    }
 
-            bool operator<(const Iterator& rhs) const {
-                return index_it < rhs.index_it;
+    // Makes room for count assigned elements. When they replace every live element there is nothing
+    // worth keeping, so the old ones are dropped before growing instead of being relocated.
+    void prepare_assign(size_t count) {
+        if (count + 1 > capacity_) {
+            if (count >= size_) {
+                clear();
             }
+            grow(count);
+        }
+    }
+
+    template<bool Move>
+    void assign_from(const CCircularBufferExt& val_) {
+        if (val_.size_ == 0) {
+            return;
+        }
 
-            bool operator>(const Iterator& rhs) const {
-                return index_it > rhs.index_it;
+        prepare_assign(val_.size_);
+        size_t offset = 0;
+        val_.for_segments(val_.wrap(val_.begin_), val_.size_, [this, &offset](T* from_, size_t, size_t n) {
+            if constexpr (Move && !std::is_trivially_copyable_v<T>) {
+                assign_range(offset, std::make_move_iterator(from_), n);
+            } else {
+                assign_range(offset, static_cast<const T*>(from_), n);
             }
-    };
+            offset += n;
+        });
+    }
+
+    void swap_storage(CCircularBufferExt& rhs) noexcept {
+        std::swap(elements, rhs.elements);
+        std::swap(size_, rhs.size_);
+        std::swap(capacity_, rhs.capacity_);
+        std::swap(begin_, rhs.begin_);
+        std::swap(end_, rhs.end_);
+        std::swap(growth_factor_, rhs.growth_factor_);
+        stats_.on_relocate(capacity_);
+        rhs.stats_.on_relocate(rhs.capacity_);
+    }
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+    typedef Allocator           allocator_type;
+    typedef std::pair<T*, size_t> array_range;
+    typedef std::pair<array_range, array_range> array_range_pair;
+
+    typedef CCircularBufferIterator<T, false>       Iterator;
+    typedef CCircularBufferIterator<T, true>        ConstIterator;
+    typedef Iterator                                iterator;
+    typedef ConstIterator                           const_iterator;
+    typedef std::reverse_iterator<Iterator>         reverse_iterator;
+    typedef std::reverse_iterator<ConstIterator>    const_reverse_iterator;
+
+    size_t capacity() const {
+        return capacity_ == 0 ? 0 : capacity_ - 1;
+    }
+
+    // Largest capacity whose storage, rounded up by Indexing, the allocator can still provide.
+    size_t max_size() const {
+        return alloc_traits::max_size(allocator) / 2 - 1;
+    }
+
+    double growth_factor() const {
+        return growth_factor_;
+    }
+
+    void set_growth_factor(double factor) {
+        if (!(factor > 1.0))
+            throw std::invalid_argument("Error: growth factor must be greater than 1");
 
-    size_t capacity() {
-        return capacity_ - 1;
+        growth_factor_ = factor;
     }
 
-    size_t size() {
+    size_t size() const {
         return size_;
     }
 
-    explicit CCircularBufferExt(size_t _capacity_) {
-        elements = allocator.allocate(_capacity_ + 1);
-        capacity_ = _capacity_ + 1;
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    explicit CCircularBufferExt(size_t _capacity_, const Allocator& allocator_ = Allocator()) : allocator(allocator_) {
+        capacity_ = Indexing::storage_size(_capacity_);
+        elements = allocate_storage(capacity_);
         size_ = 0;
         begin_ = 0;
         end_ = 0;
     }
 
-    CCircularBufferExt(const CCircularBufferExt& rhs) {
-        capacity_ = rhs.capacity_;
-        elements = allocator.allocate(rhs.size_);
-        size_ = rhs.size_;
-        begin_ = rhs.begin_;
-        end_ = rhs.end_;
-        
-        for (size_t i = 0; i < size_; ++i) {
-            *elements[i] = rhs.elements[i];
+    CCircularBufferExt(const CCircularBufferExt& rhs)
+        : CCircularBufferExt(rhs, alloc_traits::select_on_container_copy_construction(rhs.allocator)) {}
+
+    CCircularBufferExt(const CCircularBufferExt& rhs, const Allocator& allocator_) : allocator(allocator_) {
+        construct_from<false>(rhs);
+    }
+
+    CCircularBufferExt(CCircularBufferExt&& rhs) noexcept : allocator(std::move(rhs.allocator)) {
+        swap_storage(rhs);
+    }
+
+    CCircularBufferExt(CCircularBufferExt&& rhs, const Allocator& allocator_) : allocator(allocator_) {
+        if (allocator == rhs.allocator) {
+            swap_storage(rhs);
+        } else {
+            construct_from<true>(rhs);
         }
     }
 
-    CCircularBufferExt(size_t t, const_reference val_) {
-        elements = allocator.allocate(t + 1);
-        capacity_ = t + 1;
-        size_ = 0;
-        begin_ = 0;
-        end_ = 0;
-        for (auto i = 0; i < t; ++i) {
+    CCircularBufferExt(size_t t, const_reference val_, const Allocator& allocator_ = Allocator())
+        : CCircularBufferExt(t, allocator_) {
+        for (size_t i = 0; i < t; ++i) {
             push_back(val_);
         }
     }
 
-    CCircularBufferExt(std::initializer_list<T> list) {
-        elements = allocator.allocate(list.size() + 1);
-        capacity_ = list.size() + 1;
-        size_ = 0;
-        begin_ = 0;
-        end_ = 0;
+    CCircularBufferExt(std::initializer_list<T> list, const Allocator& allocator_ = Allocator())
+        : CCircularBufferExt(list.size(), allocator_) {
         for (auto c : list) {
             push_back(c);
         }
     }
 
+    allocator_type get_allocator() const {
+        return allocator;
+    }
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
     void clear() {
+        destroy_range(begin_, size_);
         size_ = 0;
         begin_ = 0;
         end_ = 0;
-        allocator.deallocate(elements, capacity_);
     }
     
     CCircularBufferExt& operator=(const std::initializer_list<T>& list) {
-        clear();
-        elements = allocator.allocate(list.size() + 1);
-        capacity_ = list.size() + 1;
-        size_ = 0;
-        begin_ = 0;
-        end_ = 0;
-        for (auto c : list) {
-            push_back(c);
+        CCircularBufferExt copy(list, allocator);
+        swap_storage(copy);
+
+        return *this;
+    }
+
+    CCircularBufferExt& operator=(const CCircularBufferExt& rhs) {
+        if (this != &rhs) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                CCircularBufferExt copy(rhs, rhs.allocator);
+                swap_storage(copy);
+                std::swap(allocator, copy.allocator);
+            } else {
+                CCircularBufferExt copy(rhs, allocator);
+                swap_storage(copy);
+            }
+        }
+
+        return *this;
+    }
+
+    CCircularBufferExt& operator=(CCircularBufferExt&& rhs) noexcept(kMoveAssignNoexcept) {
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            CCircularBufferExt moved(std::move(rhs));
+            swap_storage(moved);
+            std::swap(allocator, moved.allocator);
+        } else {
+            CCircularBufferExt moved(std::move(rhs), allocator);
+            swap_storage(moved);
+        }
+
+        return *this;
+    }
+
+    void swap(CCircularBufferExt& rhs) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            std::swap(allocator, rhs.allocator);
         }
+        swap_storage(rhs);
     }
 
+    explicit CCircularBufferExt(const Allocator& allocator_) : allocator(allocator_) {}
+
     CCircularBufferExt() {
         capacity_ = 0;
         size_ = 0;
@@ -583,7 +1671,10 @@ public:
     }
 
     ~CCircularBufferExt() {
-        allocator.deallocate(elements, capacity_);
+        if (elements != nullptr) {
+            destroy_range(begin_, size_);
+            deallocate_storage(elements, capacity_);
+        }
     }
 
     T& operator[](size_t idx) const {
@@ -592,53 +1683,141 @@ public:
         if (idx >= size_)
             throw std::out_of_range("Error: index is out of range"); 
         
-        return elements[((idx % size_) + begin_) % capacity_];
+        return elements[wrap(begin_ + idx)];
     }
 
     Iterator push_front(const_reference element_) {
+        return emplace_front(element_);
+    }
 
-        if (size_ + 1 == capacity_) {
-            capacity_ = 2 * capacity_ + 1;
-            T* temp = allocator.allocate(capacity_);
-            for (size_t i = 0; i < size_; ++i) {
-                allocator.construct(temp + i, elements[i]);
-            }
-            allocator.deallocate(elements, (capacity_ - 1) / 2 );
-            elements = temp;
-        } 
-        
-        begin_ = (begin_ - 1 + capacity_) % capacity_;
-        allocator.construct(&elements[begin_], element_);
+    Iterator push_front(T&& element_) {
+        return emplace_front(std::move(element_));
+    }
+
+    template<typename... Args>
+    Iterator emplace_front(Args&&... args) {
+        if (size_ + 1 >= capacity_) {
+            T element_(std::forward<Args>(args)...);
+            grow(size_ + 1);
+            begin_ = wrap(begin_ - 1 + capacity_);
+            alloc_traits::construct(allocator, &elements[begin_], std::move(element_));
+        } else {
+            begin_ = wrap(begin_ - 1 + capacity_);
+            alloc_traits::construct(allocator, &elements[begin_], std::forward<Args>(args)...);
+        }
         size_++;
+        stats_.on_push(begin_, 1, capacity_, size_);
 
         return begin();
     }
 
     Iterator push_back(const_reference element_) {
+        return emplace_back(element_);
+    }
 
-        if (size_ + 1 == capacity_) {
-            capacity_ = 2 * capacity_ + 1;
-            T* temp = allocator.allocate(capacity_);
-            for (size_t i = 0; i < size_; ++i) {
-                allocator.construct(temp + i, elements[i]);
-            }
-            allocator.deallocate(elements, (capacity_ - 1) / 2 );
-            elements = temp;
-        }
+    Iterator push_back(T&& element_) {
+        return emplace_back(std::move(element_));
+    }
 
-        allocator.construct(&elements[end_], element_);
-        end_ = (end_ + 1) % capacity_;
+    template<typename... Args>
+    Iterator emplace_back(Args&&... args) {
+        if (size_ + 1 >= capacity_) {
+            T element_(std::forward<Args>(args)...);
+            grow(size_ + 1);
+            alloc_traits::construct(allocator, &elements[end_], std::move(element_));
+        } else {
+            alloc_traits::construct(allocator, &elements[end_], std::forward<Args>(args)...);
+        }
+        stats_.on_push(end_, 1, capacity_, size_ + 1);
+        end_ = wrap(end_ + 1);
         size_++;
 
         return end();
     }
 
+    void push_back_n(const T* from_, size_t count) {
+        if (size_ + count + 1 > capacity_) {
+            grow(size_ + count);
+        }
+
+        for_segments(end_, count, [from_](T* to_, size_t offset, size_t n) {
+            ElementRange<T>::copy_construct(from_ + offset, n, to_);
+        });
+        stats_.on_push(end_, count, capacity_, size_ + count);
+        end_ = wrap(end_ + count);
+        size_ += count;
+    }
+
+    size_t pop_front_n(T* to_, size_t count) {
+        count = std::min(count, size_);
+        if (count == 0)
+            return 0;
+
+        for_segments(begin_, count, [to_](T* from_, size_t offset, size_t n) {
+            ElementRange<T>::move_assign(from_, n, to_ + offset);
+        });
+        stats_.on_pop(begin_, count, capacity_);
+        destroy_range(begin_, count);
+        begin_ = wrap(begin_ + count);
+        size_ -= count;
+
+        return count;
+    }
+
+#ifdef __cpp_lib_span
+    void push_back_n(std::span<const T> from_) {
+        push_back_n(from_.data(), from_.size());
+    }
+
+    size_t pop_front_n(std::span<T> to_) {
+        return pop_front_n(to_.data(), to_.size());
+    }
+#endif
+
+    array_range_pair prepare(size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>, "prepare() hands out raw storage and requires trivially copyable T");
+
+        if (size_ + count + 1 > capacity_) {
+            grow(size_ + count);
+        }
+
+        return segments(end_, count);
+    }
+
+    void commit(size_t count) {
+        if (size_ + count >= capacity_)
+            throw std::out_of_range("Error: committing more elements than prepared");
+
+        stats_.on_push(end_, count, capacity_, size_ + count);
+        end_ = wrap(end_ + count);
+        size_ += count;
+    }
+
+    array_range_pair peek(size_t count) const {
+        return segments(begin_, std::min(count, size_));
+    }
+
+    void consume(size_t count) {
+        if (count > size_)
+            throw std::out_of_range("Error: consuming more elements than stored");
+        if (count == 0)
+            return;
+
+        stats_.on_pop(begin_, count, capacity_);
+        destroy_range(begin_, count);
+        begin_ = wrap(begin_ + count);
+        size_ -= count;
+    }
+
     T pop_front() {
         if (size_ > 0) {
+            T element_ = std::move(elements[begin_]);
+            stats_.on_pop(begin_, 1, capacity_);
+            alloc_traits::destroy(allocator, &elements[begin_]);
             size_--;
-            begin_ = (begin_ + 1) % capacity_;
+            begin_ = wrap(begin_ + 1);
 
-            return elements[(begin_ - 1) % capacity_];
+            return element_;
         } else {
             throw std::out_of_range("Empty buffer");
         }
@@ -646,10 +1825,14 @@ public:
 
     T pop_back() {
         if (size_ > 0) {
+            size_t idx_ = wrap(capacity_ + end_ - 1);
+            T element_ = std::move(elements[idx_]);
+            stats_.on_pop(idx_, 1, capacity_);
+            alloc_traits::destroy(allocator, &elements[idx_]);
             size_--;
-            end_ = (capacity_ + end_ - 1) % capacity_;
+            end_ = idx_;
 
-            return elements[(end_) % capacity_];
+            return element_;
         } else {
             throw std::out_of_range("Empty buffer");
         }
@@ -657,129 +1840,312 @@ public:
 
     Iterator insert(const_reference element_, Iterator index) {
         size_t idx_ = index - begin();
-
-        if (size_  + 1 == capacity_) {
-            capacity_ = 2 * capacity_ + 1;
-            T* temp = allocator.allocate(capacity_);
-            for (size_t i = 0; i < size_; ++i) {
-                allocator.construct(temp + i, elements[i]);
-            }
-            allocator.deallocate(elements, (capacity_ - 1) / 2 );
-            elements = temp;
+        T value_(element_);
+        if (size_ + 2 > capacity_) {
+            grow(size_ + 1);
         }
-
-        for (size_t i = end_; i != idx_; --i) {
-            allocator.construct(&elements[i % capacity_], elements[(i - 1) % capacity_]);
-        }
-
-        allocator.construct(&elements[idx_], element_);
-        size_++;
-        end_ = (end_ + 1) % capacity_;
+        insert_gap(idx_, 1, [&value_](size_t) -> T&& { return std::move(value_); });
 
         return Iterator(elements, capacity_, idx_, begin_);
     }
 
     Iterator insert(Iterator pos, size_t times, const_reference element_) {
-        for (size_t i = 0; i < times; ++i) {
-            insert(element_, pos);
-        }
         size_t idx_ = pos - begin();
+        T value_(element_);
+        if (size_ + times + 1 > capacity_) {
+            grow(size_ + times);
+        }
+        insert_gap(idx_, times, [&value_](size_t) -> const T& { return value_; });
 
         return Iterator(elements, capacity_, idx_, begin_);
     }
 
-    Iterator insert(Iterator pos, Iterator from_, Iterator to_) {
-        CCircularBufferExt copy(1);
-        size_t idx_;
-        for (auto i = from_; i < to_; ++i) {
-            idx_ = i - begin();
-            copy.push_back(elements[idx_]);
+    Iterator insert(Iterator pos, ConstIterator from_, ConstIterator to_) {
+        size_t idx_ = pos - begin();
+        CCircularBufferExt copy(to_ - from_, allocator);
+        for (auto i = from_; i != to_; ++i) {
+            copy.push_back(*i);
         }
-        for (auto i = from_; i < to_; ++i) {
-            insert(copy[i - from_], pos);
-            pos += 1;
+        T* values = copy.array_one().first;
+        if (size_ + copy.size() + 1 > capacity_) {
+            grow(size_ + copy.size());
         }
+        insert_gap(idx_, copy.size(), [values](size_t i) -> T&& { return std::move(values[i]); });
 
-        return pos;
+        return Iterator(elements, capacity_, idx_, begin_);
     }
 
     Iterator insert(Iterator pos, const CCircularBufferExt& val) {
         return insert(pos, val.begin(), val.end());
     }
 
-    void assign(const CCircularBufferExt& val_) {
-        for (auto i = val_.begin(); i < val_.end(); ++i) {
-            pop_front();
+    // Replaces the first elements with the assigned ones in a single pass over the storage; elements past
+    // them are kept and the buffer grows when it held fewer. Iterators must not point into this buffer.
+    template<class InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void assign(InputIt first_, InputIt last_) {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<InputIt>::iterator_category>) {
+            size_t count = std::distance(first_, last_);
+            prepare_assign(count);
+            assign_range(0, first_, count);
+        } else {
+            for (size_t i = 0; i < size_ && first_ != last_; ++i, ++first_) {
+                size_t pos = wrap(begin_ + i);
+                elements[pos] = *first_;
+                stats_.on_push(pos, 1, capacity_, size_);
+            }
+            for (; first_ != last_; ++first_) {
+                emplace_back(*first_);
+            }
         }
+    }
 
-        for (auto i = val_.begin(); i < val_.end(); ++i) {
-            push_front(val_[val_.end() - i - 1]);
-        }
+    void assign(std::initializer_list<T> list) {
+        assign(list.begin(), list.end());
     }
 
-    void assign(size_t n, const_reference val_) {
-        for (size_t i = 0; i < n; ++i) {
-            pop_front();
+    void assign(const CCircularBufferExt& val_) {
+        if (this != &val_) {
+            assign_from<false>(val_);
         }
+    }
 
-        for (size_t i = 0; i < n; ++i) {
-            push_front(val_);
+    void assign(CCircularBufferExt&& val_) {
+        if (this != &val_) {
+            assign_from<true>(val_);
         }
     }
 
+    void assign(size_t n, const_reference val_) {
+        T value_(val_);
+        prepare_assign(n);
+        assign_runs(0, n, [&value_](size_t) -> const T& { return value_; });
+    }
+
     Iterator erase(size_t idx_) {
-        if (size_  + 1 == capacity_) {
-            capacity_ = 2 * capacity_ + 1;
-            T* temp = allocator.allocate(capacity_);
-            for (size_t i = 0; i < size_; ++i) {
-                allocator.construct(temp + i, elements[i]);
-            }
-            allocator.deallocate(elements, (capacity_ - 1) / 2 );
-            elements = temp;
-        }
+        erase_gap(idx_, 1);
 
-        for (size_t i = idx_; i < end_; ++i) {
-            allocator.construct(&elements[i % capacity_], elements[(i + 1) % capacity_]);
-        }
+        return Iterator(elements, capacity_, idx_, begin_);
+    }
+
+    Iterator erase(const Iterator& idx) {
+        return erase(static_cast<size_t>(idx - begin()));
+    }
 
-        end_ = (end_ - 1) % capacity_;
+    Iterator erase(Iterator first_, Iterator last_) {
+        size_t idx_ = first_ - begin();
+        erase_gap(idx_, last_ - first_);
 
         return Iterator(elements, capacity_, idx_, begin_);
     }
 
-    Iterator erase(Iterator& idx) {
-        size_t index = idx - begin();
-        erase(index);
+    void reserve(size_t _capacity_) {
+        size_t new_capacity_ = Indexing::storage_size(_capacity_);
+        if (new_capacity_ > capacity_) {
+            relocate(new_capacity_);
+        }
+    }
 
-        return Iterator(elements, capacity_, index, begin_);
+    array_range array_one() const {
+        return segments(begin_, size_).first;
     }
 
-    void reserve(size_t _capacity_) {
-        capacity_ =  _capacity_ + 1;
-        elements = allocator.allocate(_capacity_ + 1);
+    array_range array_two() const {
+        return segments(begin_, size_).second;
+    }
+
+    bool is_linearized() const {
+        return begin_ + size_ <= capacity_;
+    }
+
+    T* linearize() {
+        if (is_linearized()) {
+            return elements + begin_;
+        }
+
+        size_t head = capacity_ - begin_;
+        size_t tail = size_ - head;
+        for (size_t i = 0; i < head; ++i) {
+            if (tail + i < begin_) {
+                alloc_traits::construct(allocator, &elements[tail + i], std::move(elements[begin_ + i]));
+            } else {
+                elements[tail + i] = std::move(elements[begin_ + i]);
+            }
+        }
+        for (size_t i = std::max(begin_, size_); i < capacity_; ++i) {
+            alloc_traits::destroy(allocator, &elements[i]);
+        }
+        std::rotate(elements, elements + tail, elements + size_);
+
+        begin_ = 0;
+        end_ = wrap(size_);
+        stats_.on_relocate(capacity_);
+
+        return elements;
     }
 
-    Iterator begin() const {
+    Iterator begin() {
         return Iterator(elements, capacity_, 0, begin_);
     }
 
-    Iterator end() const {
+    Iterator end() {
         return Iterator(elements, capacity_, size_, begin_);
     }
 
+    ConstIterator begin() const {
+        return ConstIterator(elements, capacity_, 0, begin_);
+    }
+
+    ConstIterator end() const {
+        return ConstIterator(elements, capacity_, size_, begin_);
+    }
+
+    ConstIterator cbegin() const {
+        return begin();
+    }
+
+    ConstIterator cend() const {
+        return end();
+    }
+
+    reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crbegin() const {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const {
+        return rend();
+    }
+
     T& front() const {
         return elements[begin_];
     }
 
     T& back() const {
-        return elements[(size_ + begin_ - 1) % capacity_];
+        return elements[wrap(size_ + begin_ - 1)];
     }
 
     bool operator==(const CCircularBufferExt& rhs) const {
-        return std::equal(this->begin(), this->end(), rhs.begin(), rhs.end());
+        return size_ == rhs.size_ && equal_segments(segments(begin_, size_), rhs.segments(rhs.begin_, rhs.size_));
     }
 
     bool operator!=(const CCircularBufferExt& rhs) const {
         return !(*this == rhs);
     }
-};
\ No newline at end of file
+};
+
+template<typename T, class Allocator = std::allocator<T>>
+using CCircularBufferPow2 = CCircularBuffer<T, Allocator, Pow2Indexing>;
+
+template<typename T, class Allocator = std::allocator<T>>
+using CCircularBufferExtPow2 = CCircularBufferExt<T, Allocator, Pow2Indexing>;
+
+template<class Buffer>
+struct is_circular_buffer : std::false_type {};
+
+template<typename T, class Allocator, class Indexing, class Stats>
+struct is_circular_buffer<CCircularBuffer<T, Allocator, Indexing, Stats>> : std::true_type {};
+
+template<typename T, class Allocator, class Indexing, class Stats>
+struct is_circular_buffer<CCircularBufferExt<T, Allocator, Indexing, Stats>> : std::true_type {};
+
+template<class Buffer, typename Result = void>
+using enable_if_circular_buffer_t = std::enable_if_t<is_circular_buffer<std::remove_cv_t<Buffer>>::value, Result>;
+
+template<class Buffer, class Function>
+enable_if_circular_buffer_t<Buffer, Function> for_each(Buffer& buffer, Function function) {
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    return std::for_each(two.first, two.first + two.second,
+                         std::for_each(one.first, one.first + one.second, std::move(function)));
+}
+
+template<class Buffer, class OutputIterator>
+enable_if_circular_buffer_t<Buffer, OutputIterator> copy(const Buffer& buffer, OutputIterator out) {
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    out = std::copy(one.first, one.first + one.second, out);
+
+    return std::copy(two.first, two.first + two.second, out);
+}
+
+template<class Buffer>
+enable_if_circular_buffer_t<Buffer> fill(Buffer& buffer, const typename Buffer::value_type& value) {
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    std::fill(one.first, one.first + one.second, value);
+    std::fill(two.first, two.first + two.second, value);
+}
+
+template<class Buffer>
+enable_if_circular_buffer_t<Buffer, decltype(std::declval<Buffer&>().begin())>
+find(Buffer& buffer, const typename Buffer::value_type& value) {
+    auto one = buffer.array_one();
+    auto found = std::find(one.first, one.first + one.second, value);
+    if (found != one.first + one.second) {
+        return buffer.begin() + (found - one.first);
+    }
+
+    auto two = buffer.array_two();
+    found = std::find(two.first, two.first + two.second, value);
+
+    return buffer.begin() + (one.second + (found - two.first));
+}
+
+template<class Buffer, typename Value>
+enable_if_circular_buffer_t<Buffer, Value> accumulate(const Buffer& buffer, Value init) {
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    init = std::accumulate(one.first, one.first + one.second, std::move(init));
+
+    return std::accumulate(two.first, two.first + two.second, std::move(init));
+}
+
+template<class Buffer, typename Value, class BinaryOperation>
+enable_if_circular_buffer_t<Buffer, Value> accumulate(const Buffer& buffer, Value init, BinaryOperation operation) {
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    init = std::accumulate(one.first, one.first + one.second, std::move(init), operation);
+
+    return std::accumulate(two.first, two.first + two.second, std::move(init), operation);
+}
+
+template<class Buffer, class OutputIterator, class UnaryOperation>
+enable_if_circular_buffer_t<Buffer, OutputIterator> transform(const Buffer& buffer, OutputIterator out, UnaryOperation operation) {
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    out = std::transform(one.first, one.first + one.second, out, operation);
+
+    return std::transform(two.first, two.first + two.second, out, operation);
+}
+
+template<class Buffer, class UnaryOperation>
+enable_if_circular_buffer_t<Buffer> transform(Buffer& buffer, UnaryOperation operation) {
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    std::transform(one.first, one.first + one.second, one.first, operation);
+    std::transform(two.first, two.first + two.second, two.first, operation);
+}
+
+template<class Lhs, class Rhs>
+std::enable_if_t<is_circular_buffer<Lhs>::value && is_circular_buffer<Rhs>::value, bool>
+equal(const Lhs& lhs, const Rhs& rhs) {
+    return lhs.size() == rhs.size() &&
+           equal_segments(std::make_pair(lhs.array_one(), lhs.array_two()),
+                          std::make_pair(rhs.array_one(), rhs.array_two()));
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+const size_t kCacheLineSize = 64;
+const size_t kSpinsBeforeYield = 64;
+
+enum class FullPolicy {
+    kReject,
+    kOverwrite,
+    kBlock
+};
+
+template<typename T, class Allocator = std::allocator<T>, class Indexing = ModuloIndexing>
+class SpscCircularBuffer {
+private:
+    typedef std::allocator_traits<Allocator> alloc_traits;
+
+    T* elements = nullptr;
+    Allocator allocator;
+    size_t capacity_ = 0;
+
+    alignas(kCacheLineSize) std::atomic<size_t> begin_{0};
+    size_t cached_end_ = 0;
+
+    alignas(kCacheLineSize) std::atomic<size_t> end_{0};
+    size_t cached_begin_ = 0;
+
+    size_t wrap(size_t idx) const {
+        return Indexing::wrap(idx, capacity_);
+    }
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef Allocator           allocator_type;
+
+    explicit SpscCircularBuffer(size_t _capacity_, const Allocator& allocator_ = Allocator()) : allocator(allocator_) {
+        capacity_ = Indexing::storage_size(_capacity_);
+        elements = alloc_traits::allocate(allocator, capacity_);
+    }
+
+    SpscCircularBuffer() : SpscCircularBuffer(kDefaultCapacity - 1) {}
+
+    SpscCircularBuffer(const SpscCircularBuffer&) = delete;
+    SpscCircularBuffer& operator=(const SpscCircularBuffer&) = delete;
+
+    ~SpscCircularBuffer() {
+        size_t idx_ = begin_.load(std::memory_order_relaxed);
+        size_t end = end_.load(std::memory_order_relaxed);
+        for (; idx_ != end; idx_ = wrap(idx_ + 1)) {
+            alloc_traits::destroy(allocator, &elements[idx_]);
+        }
+        alloc_traits::deallocate(allocator, elements, capacity_);
+    }
+
+    size_t capacity() const {
+        return capacity_ - 1;
+    }
+
+    size_t size() const {
+        size_t begin = begin_.load(std::memory_order_acquire);
+        size_t end = end_.load(std::memory_order_acquire);
+
+        return wrap(end + capacity_ - begin);
+    }
+
+    bool empty() const {
+        return begin_.load(std::memory_order_acquire) == end_.load(std::memory_order_acquire);
+    }
+
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t end = end_.load(std::memory_order_relaxed);
+        size_t next = wrap(end + 1);
+        if (next == cached_begin_) {
+            cached_begin_ = begin_.load(std::memory_order_acquire);
+            if (next == cached_begin_) {
+                return false;
+            }
+        }
+
+        alloc_traits::construct(allocator, &elements[end], std::forward<Args>(args)...);
+        end_.store(next, std::memory_order_release);
+
+        return true;
+    }
+
+    bool try_push(const_reference element_) {
+        return try_emplace(element_);
+    }
+
+    bool try_push(T&& element_) {
+        return try_emplace(std::move(element_));
+    }
+
+    bool try_pop(T& element_) {
+        size_t begin = begin_.load(std::memory_order_relaxed);
+        if (begin == cached_end_) {
+            cached_end_ = end_.load(std::memory_order_acquire);
+            if (begin == cached_end_) {
+                return false;
+            }
+        }
+
+        element_ = std::move(elements[begin]);
+        alloc_traits::destroy(allocator, &elements[begin]);
+        begin_.store(wrap(begin + 1), std::memory_order_release);
+
+        return true;
+    }
+};
+
+template<typename T, class Allocator = std::allocator<T>, class Indexing = ModuloIndexing>
+class MpmcCircularBuffer {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* element() {
+            return reinterpret_cast<T*>(storage);
+        }
+    };
+
+    typedef std::allocator_traits<Allocator> alloc_traits;
+    typedef typename alloc_traits::template rebind_alloc<Slot> SlotAllocator;
+    typedef typename alloc_traits::template rebind_traits<Slot> slot_traits;
+
+    Slot* slots = nullptr;
+    Allocator allocator;
+    SlotAllocator slot_allocator;
+    size_t capacity_ = 0;
+    FullPolicy policy_ = FullPolicy::kReject;
+
+    alignas(kCacheLineSize) std::atomic<size_t> begin_{0};
+    alignas(kCacheLineSize) std::atomic<size_t> end_{0};
+
+    size_t wrap(size_t idx) const {
+        return Indexing::wrap(idx, capacity_);
+    }
+
+    static void backoff(size_t& attempt) {
+        if (++attempt >= kSpinsBeforeYield) {
+            std::this_thread::yield();
+        }
+    }
+
+    template<class Consumer>
+    bool consume(Consumer&& consumer) {
+        size_t pos = begin_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[wrap(pos)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos + 1);
+
+            if (diff == 0) {
+                if (begin_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    consumer(*slot.element());
+                    alloc_traits::destroy(allocator, slot.element());
+                    slot.sequence.store(pos + capacity_, std::memory_order_release);
+
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = begin_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef Allocator           allocator_type;
+
+    explicit MpmcCircularBuffer(size_t _capacity_, FullPolicy policy = FullPolicy::kReject,
+                                const Allocator& allocator_ = Allocator())
+        : allocator(allocator_), slot_allocator(allocator_) {
+        // With a single slot the sequence published by a push equals the free marker of the next lap.
+        if (_capacity_ < 2)
+            throw std::invalid_argument("Error: MPMC buffer must hold at least two elements");
+
+        capacity_ = Indexing::storage_size(_capacity_ - 1);
+        policy_ = policy;
+        slots = slot_traits::allocate(slot_allocator, capacity_);
+        for (size_t i = 0; i < capacity_; ++i) {
+            new (&slots[i].sequence) std::atomic<size_t>(i);
+        }
+    }
+
+    MpmcCircularBuffer() : MpmcCircularBuffer(kDefaultCapacity) {}
+
+    MpmcCircularBuffer(const MpmcCircularBuffer&) = delete;
+    MpmcCircularBuffer& operator=(const MpmcCircularBuffer&) = delete;
+
+    ~MpmcCircularBuffer() {
+        while (drop_front()) {
+        }
+        slot_traits::deallocate(slot_allocator, slots, capacity_);
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t size() const {
+        size_t begin = begin_.load(std::memory_order_acquire);
+        size_t end = end_.load(std::memory_order_acquire);
+
+        return end > begin ? std::min(end - begin, capacity_) : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    FullPolicy policy() const {
+        return policy_;
+    }
+
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t pos = end_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[wrap(pos)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos);
+
+            if (diff == 0) {
+                if (end_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    alloc_traits::construct(allocator, slot.element(), std::forward<Args>(args)...);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+
+                    return true;
+                }
+            } else if (diff < 0) {
+                if (policy_ != FullPolicy::kOverwrite) {
+                    return false;
+                }
+                drop_front();
+                pos = end_.load(std::memory_order_relaxed);
+            } else {
+                pos = end_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_push(const_reference element_) {
+        return try_emplace(element_);
+    }
+
+    bool try_push(T&& element_) {
+        return try_emplace(std::move(element_));
+    }
+
+    bool try_pop(T& element_) {
+        return consume([&element_](T& slot_element) {
+            element_ = std::move(slot_element);
+        });
+    }
+
+    bool drop_front() {
+        return consume([](T&) {});
+    }
+
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        size_t attempt = 0;
+        while (!try_emplace(std::forward<Args>(args)...)) {
+            backoff(attempt);
+        }
+    }
+
+    void push(const_reference element_) {
+        emplace(element_);
+    }
+
+    void push(T&& element_) {
+        emplace(std::move(element_));
+    }
+
+    T pop() {
+        std::optional<T> result;
+        size_t attempt = 0;
+        while (!consume([&result](T& slot_element) { result.emplace(std::move(slot_element)); })) {
+            backoff(attempt);
+        }
+
+        return std::move(*result);
+    }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#ifdef __linux__
+
+#include "CCircularBuffer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+template<typename T>
+class MagicCircularBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "MagicCircularBuffer stores raw bytes and requires trivially copyable T");
+private:
+    T* elements = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    size_t begin_ = 0;
+
+    size_t bytes() const {
+        return capacity_ * sizeof(T);
+    }
+
+    size_t wrap(size_t idx) const {
+        return idx >= capacity_ ? idx - capacity_ : idx;
+    }
+
+    static size_t storage_size(size_t _capacity_) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t bytes_ = std::max<size_t>(_capacity_, 1) * sizeof(T);
+        bytes_ = (bytes_ + page - 1) / page * page;
+        while (bytes_ % sizeof(T) != 0) {
+            bytes_ += page;
+        }
+
+        return bytes_ / sizeof(T);
+    }
+
+    void map() {
+        int fd = memfd_create("CCircularBuffer", MFD_CLOEXEC);
+        if (fd == -1)
+            throw std::system_error(errno, std::generic_category(), "memfd_create");
+
+        if (ftruncate(fd, static_cast<off_t>(bytes())) == -1) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "ftruncate");
+        }
+
+        void* reserved = mmap(nullptr, 2 * bytes(), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserved == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+
+        char* base = static_cast<char*>(reserved);
+        for (char* half : {base, base + bytes()}) {
+            if (mmap(half, bytes(), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                int error = errno;
+                munmap(base, 2 * bytes());
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "mmap");
+            }
+        }
+        close(fd);
+
+        elements = reinterpret_cast<T*>(base);
+    }
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef value_type*         iterator;
+    typedef const value_type*   const_iterator;
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+    typedef std::pair<T*, size_t> array_range;
+
+    explicit MagicCircularBuffer(size_t _capacity_) {
+        capacity_ = storage_size(_capacity_);
+        map();
+    }
+
+    MagicCircularBuffer() : MagicCircularBuffer(kDefaultCapacity) {}
+
+    MagicCircularBuffer(const MagicCircularBuffer&) = delete;
+    MagicCircularBuffer& operator=(const MagicCircularBuffer&) = delete;
+
+    MagicCircularBuffer(MagicCircularBuffer&& rhs) noexcept {
+        swap(rhs);
+    }
+
+    MagicCircularBuffer& operator=(MagicCircularBuffer&& rhs) noexcept {
+        MagicCircularBuffer moved(std::move(rhs));
+        swap(moved);
+
+        return *this;
+    }
+
+    ~MagicCircularBuffer() {
+        if (elements != nullptr) {
+            munmap(elements, 2 * bytes());
+        }
+    }
+
+    void swap(MagicCircularBuffer& rhs) noexcept {
+        std::swap(elements, rhs.elements);
+        std::swap(size_, rhs.size_);
+        std::swap(capacity_, rhs.capacity_);
+        std::swap(begin_, rhs.begin_);
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    void clear() {
+        size_ = 0;
+        begin_ = 0;
+    }
+
+    T* data() const {
+        return elements + begin_;
+    }
+
+    T& operator[](size_t idx) const {
+        if (idx >= size_)
+            throw std::out_of_range("Error: index is out of range");
+
+        return elements[begin_ + idx];
+    }
+
+    T& front() const {
+        return elements[begin_];
+    }
+
+    T& back() const {
+        return elements[begin_ + size_ - 1];
+    }
+
+    iterator begin() const {
+        return elements + begin_;
+    }
+
+    iterator end() const {
+        return elements + begin_ + size_;
+    }
+
+    void push_back(const_reference element_) {
+        elements[begin_ + size_] = element_;
+        if (size_ == capacity_) {
+            begin_ = wrap(begin_ + 1);
+        } else {
+            size_++;
+        }
+    }
+
+    T pop_front() {
+        if (size_ == 0)
+            throw std::out_of_range("Empty buffer");
+
+        T element_ = elements[begin_];
+        begin_ = wrap(begin_ + 1);
+        size_--;
+
+        return element_;
+    }
+
+    T pop_back() {
+        if (size_ == 0)
+            throw std::out_of_range("Empty buffer");
+
+        size_--;
+
+        return elements[begin_ + size_];
+    }
+
+    void push_back_n(const T* from_, size_t count) {
+        if (count > capacity_) {
+            from_ += count - capacity_;
+            count = capacity_;
+        }
+
+        // Drop the elements about to be overwritten first, so the copy starts inside the first mapping
+        // and ends within the second one.
+        if (size_ + count > capacity_) {
+            size_t evicted = size_ + count - capacity_;
+            begin_ = wrap(begin_ + evicted);
+            size_ -= evicted;
+        }
+        std::memcpy(elements + wrap(begin_ + size_), from_, count * sizeof(T));
+        size_ += count;
+    }
+
+    size_t pop_front_n(T* to_, size_t count) {
+        count = std::min(count, size_);
+        std::memcpy(to_, elements + begin_, count * sizeof(T));
+        begin_ = wrap(begin_ + count);
+        size_ -= count;
+
+        return count;
+    }
+
+    array_range prepare(size_t count) {
+        return array_range(elements + begin_ + size_, std::min(count, capacity_ - size_));
+    }
+
+    void commit(size_t count) {
+        if (size_ + count > capacity_)
+            throw std::out_of_range("Error: committing more elements than prepared");
+
+        size_ += count;
+    }
+
+    array_range peek(size_t count) const {
+        return array_range(elements + begin_, std::min(count, size_));
+    }
+
+    void consume(size_t count) {
+        if (count > size_)
+            throw std::out_of_range("Error: consuming more elements than stored");
+
+        begin_ = wrap(begin_ + count);
+        size_ -= count;
+    }
+};
+
+#endif
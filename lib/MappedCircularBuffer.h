@@ -0,0 +1,379 @@
+#pragma once
+
+#ifdef __linux__
+
+#include "CCircularBuffer.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint64_t kMappedMagic = 0x4655424352494343;
+const uint32_t kMappedFormatVersion = 1;
+const size_t kMappedHeaderSize = 64;
+
+// First kMappedHeaderSize bytes of a MappedCircularBuffer file, followed by capacity elements. begin_ and
+// end_ count the elements ever popped and pushed (the slot of position p is p % capacity), so that every
+// operation is committed by a single 8-byte store. size_ is end_ - begin_, kept for tools reading the file.
+struct MappedHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t element_size;
+    uint64_t capacity;
+    std::atomic<uint64_t> begin_;
+    std::atomic<uint64_t> end_;
+    std::atomic<uint64_t> size_;
+};
+
+static_assert(sizeof(MappedHeader) <= kMappedHeaderSize, "MappedHeader must fit before the elements");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "MappedHeader needs lock free 64-bit atomics");
+
+// Ring whose header and storage live in a file mapped with MAP_SHARED, for journals that must survive a crash
+// of the process. Opening an existing file only maps it and checks the header, so reattaching takes the same
+// time for any size. Elements are written before the header store that publishes them, and a push into a
+// full buffer moves begin_ past the slots it is about to overwrite before writing them, so a process killed
+// at any point leaves a consistent buffer in the page cache. Surviving a power loss requires msync: sync()
+// flushes the pages changed since the previous sync(), and a non-zero sync_interval calls it automatically
+// after that many pushed or popped elements.
+template<typename T>
+class MappedCircularBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedCircularBuffer stores raw bytes and requires trivially copyable T");
+    static_assert(alignof(T) <= kMappedHeaderSize, "MappedCircularBuffer elements are aligned to kMappedHeaderSize");
+private:
+    MappedHeader* header_ = nullptr;
+    T* elements = nullptr;
+    size_t capacity_ = 0;
+    size_t sync_interval_ = 0;
+    size_t unsynced_ = 0;
+    uint64_t synced_ = 0;
+
+    size_t bytes() const {
+        return kMappedHeaderSize + capacity_ * sizeof(T);
+    }
+
+    size_t slot(uint64_t pos) const {
+        return static_cast<size_t>(pos % capacity_);
+    }
+
+    uint64_t begin_pos() const {
+        return header_->begin_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t end_pos() const {
+        return header_->end_.load(std::memory_order_relaxed);
+    }
+
+    // The process may die between any two instructions, so only the compiler has to keep element writes
+    // and header stores in program order: the page cache sees them in the order the CPU retired them.
+    static void barrier() {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    void store_begin(uint64_t begin) {
+        barrier();
+        header_->begin_.store(begin, std::memory_order_relaxed);
+        header_->size_.store(end_pos() - begin, std::memory_order_relaxed);
+        barrier();
+    }
+
+    void store_end(uint64_t end) {
+        barrier();
+        header_->end_.store(end, std::memory_order_relaxed);
+        header_->size_.store(end - begin_pos(), std::memory_order_relaxed);
+        barrier();
+    }
+
+    void written(size_t count) {
+        if (sync_interval_ == 0)
+            return;
+
+        unsynced_ += count;
+        if (unsynced_ >= sync_interval_) {
+            sync();
+        }
+    }
+
+    void copy_in(const T* from_, size_t count, uint64_t to_) {
+        size_t pos = slot(to_);
+        size_t first = std::min(count, capacity_ - pos);
+        std::memcpy(static_cast<void*>(elements + pos), from_, first * sizeof(T));
+        std::memcpy(static_cast<void*>(elements), from_ + first, (count - first) * sizeof(T));
+    }
+
+    void copy_out(uint64_t from_, size_t count, T* to_) const {
+        size_t pos = slot(from_);
+        size_t first = std::min(count, capacity_ - pos);
+        std::memcpy(static_cast<void*>(to_), elements + pos, first * sizeof(T));
+        std::memcpy(static_cast<void*>(to_ + first), elements, (count - first) * sizeof(T));
+    }
+
+    static void flush(const void* from_, size_t bytes_) {
+        if (bytes_ == 0)
+            return;
+
+        uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t first = reinterpret_cast<uintptr_t>(from_) / page * page;
+        uintptr_t last = reinterpret_cast<uintptr_t>(from_) + bytes_;
+        if (msync(reinterpret_cast<void*>(first), last - first, MS_SYNC) == -1)
+            throw std::system_error(errno, std::generic_category(), "msync");
+    }
+
+    void map(const std::string& path) {
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1)
+            throw std::system_error(errno, std::generic_category(), "open");
+
+        struct stat status;
+        if (fstat(fd, &status) == -1) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "fstat");
+        }
+
+        if (status.st_size == 0) {
+            if (ftruncate(fd, static_cast<off_t>(bytes())) == -1) {
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "ftruncate");
+            }
+        } else if (static_cast<size_t>(status.st_size) != bytes()) {
+            close(fd);
+            throw std::invalid_argument("Error: journal file size does not match the capacity and element size");
+        }
+
+        void* base = mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int error = errno;
+        close(fd);
+        if (base == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), "mmap");
+
+        header_ = static_cast<MappedHeader*>(base);
+        elements = reinterpret_cast<T*>(static_cast<char*>(base) + kMappedHeaderSize);
+    }
+
+    void unmap() {
+        if (header_ != nullptr) {
+            munmap(header_, bytes());
+            header_ = nullptr;
+            elements = nullptr;
+        }
+    }
+
+    // A new file is zero filled by ftruncate. The magic number is stored last, so a file whose creation was
+    // interrupted still reads as new.
+    void format() {
+        header_->version = kMappedFormatVersion;
+        header_->element_size = static_cast<uint32_t>(sizeof(T));
+        header_->capacity = capacity_;
+        header_->begin_.store(0, std::memory_order_relaxed);
+        header_->end_.store(0, std::memory_order_relaxed);
+        header_->size_.store(0, std::memory_order_relaxed);
+        barrier();
+        header_->magic = kMappedMagic;
+        flush(header_, sizeof(MappedHeader));
+    }
+
+    void attach() {
+        if (header_->magic == 0) {
+            format();
+        }
+        if (header_->magic != kMappedMagic || header_->version != kMappedFormatVersion)
+            throw std::invalid_argument("Error: file is not a circular buffer journal of a supported version");
+        if (header_->element_size != sizeof(T) || header_->capacity != capacity_)
+            throw std::invalid_argument("Error: journal file does not match the capacity and element size");
+
+        uint64_t begin = begin_pos();
+        uint64_t end = end_pos();
+        if (end < begin || end - begin > capacity_)
+            throw std::invalid_argument("Error: journal header is corrupted");
+
+        header_->size_.store(end - begin, std::memory_order_relaxed);
+        synced_ = end;
+    }
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef std::pair<T*, size_t> array_range;
+
+    // Opens the journal at path, creating it if the file does not exist or is empty. An existing journal
+    // must have been created with the same capacity and element type.
+    MappedCircularBuffer(const std::string& path, size_t _capacity_, size_t sync_interval = 0)
+        : capacity_(_capacity_), sync_interval_(sync_interval) {
+        if (_capacity_ == 0)
+            throw std::invalid_argument("Error: mapped buffer must hold at least one element");
+
+        map(path);
+        try {
+            attach();
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    MappedCircularBuffer(const MappedCircularBuffer&) = delete;
+    MappedCircularBuffer& operator=(const MappedCircularBuffer&) = delete;
+
+    MappedCircularBuffer(MappedCircularBuffer&& rhs) noexcept {
+        swap(rhs);
+    }
+
+    MappedCircularBuffer& operator=(MappedCircularBuffer&& rhs) noexcept {
+        MappedCircularBuffer moved(std::move(rhs));
+        swap(moved);
+
+        return *this;
+    }
+
+    // Unmapping does not lose anything, the kernel writes dirty pages back on its own.
+    ~MappedCircularBuffer() {
+        unmap();
+    }
+
+    void swap(MappedCircularBuffer& rhs) noexcept {
+        std::swap(header_, rhs.header_);
+        std::swap(elements, rhs.elements);
+        std::swap(capacity_, rhs.capacity_);
+        std::swap(sync_interval_, rhs.sync_interval_);
+        std::swap(unsynced_, rhs.unsynced_);
+        std::swap(synced_, rhs.synced_);
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t size() const {
+        return static_cast<size_t>(end_pos() - begin_pos());
+    }
+
+    bool empty() const {
+        return end_pos() == begin_pos();
+    }
+
+    bool full() const {
+        return size() == capacity_;
+    }
+
+    // Number of elements ever pushed into the journal, including the ones pushed before it was reopened.
+    uint64_t pushed() const {
+        return end_pos();
+    }
+
+    void clear() {
+        store_begin(end_pos());
+    }
+
+    T& operator[](size_t idx) const {
+        if (idx >= size())
+            throw std::out_of_range("Error: index is out of range");
+
+        return elements[slot(begin_pos() + idx)];
+    }
+
+    T& front() const {
+        return elements[slot(begin_pos())];
+    }
+
+    T& back() const {
+        return elements[slot(end_pos() - 1)];
+    }
+
+    void push_back(const_reference element_) {
+        uint64_t begin = begin_pos();
+        uint64_t end = end_pos();
+        if (end - begin == capacity_) {
+            store_begin(begin + 1);
+        }
+        elements[slot(end)] = element_;
+        store_end(end + 1);
+        written(1);
+    }
+
+    // Pushes count elements with at most two copies. When count exceeds the capacity only the last
+    // capacity elements are kept, as if they were pushed one by one.
+    void push_back_n(const T* from_, size_t count) {
+        uint64_t end = end_pos() + count;
+        if (count > capacity_) {
+            from_ += count - capacity_;
+            count = capacity_;
+        }
+
+        if (end - begin_pos() > capacity_) {
+            store_begin(end - capacity_);
+        }
+        copy_in(from_, count, end - count);
+        store_end(end);
+        written(count);
+    }
+
+    T pop_front() {
+        if (empty())
+            throw std::out_of_range("Empty buffer");
+
+        uint64_t begin = begin_pos();
+        T element_ = elements[slot(begin)];
+        store_begin(begin + 1);
+        written(1);
+
+        return element_;
+    }
+
+    size_t pop_front_n(T* to_, size_t count) {
+        uint64_t begin = begin_pos();
+        count = std::min(count, size());
+        copy_out(begin, count, to_);
+        store_begin(begin + count);
+        written(count);
+
+        return count;
+    }
+
+    void consume(size_t count) {
+        if (count > size())
+            throw std::out_of_range("Error: consuming more elements than stored");
+
+        store_begin(begin_pos() + count);
+        written(count);
+    }
+
+    array_range array_one() const {
+        size_t pos = slot(begin_pos());
+
+        return array_range(elements + pos, std::min(size(), capacity_ - pos));
+    }
+
+    array_range array_two() const {
+        size_t pos = slot(begin_pos());
+
+        return array_range(elements, size() - std::min(size(), capacity_ - pos));
+    }
+
+    // Flushes the elements pushed since the previous sync() and the header to the file and waits for the write.
+    void sync() {
+        uint64_t end = end_pos();
+        size_t count = static_cast<size_t>(std::min<uint64_t>(end - synced_, capacity_));
+        size_t pos = slot(end - count);
+        size_t first = std::min(count, capacity_ - pos);
+        flush(elements + pos, first * sizeof(T));
+        flush(elements, (count - first) * sizeof(T));
+        flush(header_, sizeof(MappedHeader));
+        synced_ = end;
+        unsynced_ = 0;
+    }
+};
+
+#endif
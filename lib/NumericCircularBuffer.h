@@ -0,0 +1,382 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CCIRCULAR_BUFFER_X86_KERNELS 1
+#endif
+
+template<typename T>
+struct ScalarKernels {
+    static T sum(const T* data_, size_t count) {
+        T result = 0;
+        for (size_t i = 0; i < count; ++i) {
+            result += data_[i];
+        }
+
+        return result;
+    }
+
+    static T min(const T* data_, size_t count) {
+        T result = data_[0];
+        for (size_t i = 1; i < count; ++i) {
+            result = data_[i] < result ? data_[i] : result;
+        }
+
+        return result;
+    }
+
+    static T max(const T* data_, size_t count) {
+        T result = data_[0];
+        for (size_t i = 1; i < count; ++i) {
+            result = result < data_[i] ? data_[i] : result;
+        }
+
+        return result;
+    }
+
+    static T squared_deviation(const T* data_, size_t count, T mean_) {
+        T result = 0;
+        for (size_t i = 0; i < count; ++i) {
+            result += (data_[i] - mean_) * (data_[i] - mean_);
+        }
+
+        return result;
+    }
+
+    static T dot(const T* lhs, const T* rhs, size_t count) {
+        T result = 0;
+        for (size_t i = 0; i < count; ++i) {
+            result += lhs[i] * rhs[i];
+        }
+
+        return result;
+    }
+};
+
+#ifdef CCIRCULAR_BUFFER_X86_KERNELS
+
+// Kernels written with GCC vector extensions. They carry no target of their own and are always inlined
+// into the sse2/avx2 entry points below, so the same body is compiled once per instruction set.
+template<typename T, size_t Bytes>
+struct VectorKernels {
+    typedef T vector __attribute__((vector_size(Bytes)));
+    static constexpr size_t kWidth = Bytes / sizeof(T);
+
+    __attribute__((always_inline)) static inline void load(vector& to_, const T* from_) {
+        std::memcpy(&to_, from_, sizeof(vector));
+    }
+
+    __attribute__((always_inline)) static inline T sum(const T* data_, size_t count) {
+        vector first = {};
+        vector second = {};
+        vector chunk;
+        size_t i = 0;
+        for (; i + 2 * kWidth <= count; i += 2 * kWidth) {
+            load(chunk, data_ + i);
+            first += chunk;
+            load(chunk, data_ + i + kWidth);
+            second += chunk;
+        }
+        for (; i + kWidth <= count; i += kWidth) {
+            load(chunk, data_ + i);
+            first += chunk;
+        }
+        first += second;
+
+        T result = 0;
+        for (size_t lane = 0; lane < kWidth; ++lane) {
+            result += first[lane];
+        }
+        for (; i < count; ++i) {
+            result += data_[i];
+        }
+
+        return result;
+    }
+
+    __attribute__((always_inline)) static inline T min(const T* data_, size_t count) {
+        if (count < kWidth)
+            return ScalarKernels<T>::min(data_, count);
+
+        vector result_;
+        vector chunk;
+        load(result_, data_);
+        size_t i = kWidth;
+        for (; i + kWidth <= count; i += kWidth) {
+            load(chunk, data_ + i);
+            result_ = chunk < result_ ? chunk : result_;
+        }
+
+        T result = ScalarKernels<T>::min(data_ + i - kWidth, count - i + kWidth);
+        for (size_t lane = 0; lane < kWidth; ++lane) {
+            result = result_[lane] < result ? result_[lane] : result;
+        }
+
+        return result;
+    }
+
+    __attribute__((always_inline)) static inline T max(const T* data_, size_t count) {
+        if (count < kWidth)
+            return ScalarKernels<T>::max(data_, count);
+
+        vector result_;
+        vector chunk;
+        load(result_, data_);
+        size_t i = kWidth;
+        for (; i + kWidth <= count; i += kWidth) {
+            load(chunk, data_ + i);
+            result_ = result_ < chunk ? chunk : result_;
+        }
+
+        T result = ScalarKernels<T>::max(data_ + i - kWidth, count - i + kWidth);
+        for (size_t lane = 0; lane < kWidth; ++lane) {
+            result = result < result_[lane] ? result_[lane] : result;
+        }
+
+        return result;
+    }
+
+    __attribute__((always_inline)) static inline T squared_deviation(const T* data_, size_t count, T mean_) {
+        vector first = {};
+        vector second = {};
+        vector chunk;
+        size_t i = 0;
+        for (; i + 2 * kWidth <= count; i += 2 * kWidth) {
+            load(chunk, data_ + i);
+            chunk -= mean_;
+            first += chunk * chunk;
+            load(chunk, data_ + i + kWidth);
+            chunk -= mean_;
+            second += chunk * chunk;
+        }
+        first += second;
+
+        T result = 0;
+        for (size_t lane = 0; lane < kWidth; ++lane) {
+            result += first[lane];
+        }
+
+        return result + ScalarKernels<T>::squared_deviation(data_ + i, count - i, mean_);
+    }
+
+    __attribute__((always_inline)) static inline T dot(const T* lhs, const T* rhs, size_t count) {
+        vector first = {};
+        vector second = {};
+        vector lhs_chunk;
+        vector rhs_chunk;
+        size_t i = 0;
+        for (; i + 2 * kWidth <= count; i += 2 * kWidth) {
+            load(lhs_chunk, lhs + i);
+            load(rhs_chunk, rhs + i);
+            first += lhs_chunk * rhs_chunk;
+            load(lhs_chunk, lhs + i + kWidth);
+            load(rhs_chunk, rhs + i + kWidth);
+            second += lhs_chunk * rhs_chunk;
+        }
+        first += second;
+
+        T result = 0;
+        for (size_t lane = 0; lane < kWidth; ++lane) {
+            result += first[lane];
+        }
+
+        return result + ScalarKernels<T>::dot(lhs + i, rhs + i, count - i);
+    }
+};
+
+template<typename T>
+struct Sse2Kernels {
+    __attribute__((target("sse2"))) static T sum(const T* data_, size_t count) {
+        return VectorKernels<T, 16>::sum(data_, count);
+    }
+
+    __attribute__((target("sse2"))) static T min(const T* data_, size_t count) {
+        return VectorKernels<T, 16>::min(data_, count);
+    }
+
+    __attribute__((target("sse2"))) static T max(const T* data_, size_t count) {
+        return VectorKernels<T, 16>::max(data_, count);
+    }
+
+    __attribute__((target("sse2"))) static T squared_deviation(const T* data_, size_t count, T mean_) {
+        return VectorKernels<T, 16>::squared_deviation(data_, count, mean_);
+    }
+
+    __attribute__((target("sse2"))) static T dot(const T* lhs, const T* rhs, size_t count) {
+        return VectorKernels<T, 16>::dot(lhs, rhs, count);
+    }
+};
+
+template<typename T>
+struct Avx2Kernels {
+    __attribute__((target("avx2"))) static T sum(const T* data_, size_t count) {
+        return VectorKernels<T, 32>::sum(data_, count);
+    }
+
+    __attribute__((target("avx2"))) static T min(const T* data_, size_t count) {
+        return VectorKernels<T, 32>::min(data_, count);
+    }
+
+    __attribute__((target("avx2"))) static T max(const T* data_, size_t count) {
+        return VectorKernels<T, 32>::max(data_, count);
+    }
+
+    __attribute__((target("avx2"))) static T squared_deviation(const T* data_, size_t count, T mean_) {
+        return VectorKernels<T, 32>::squared_deviation(data_, count, mean_);
+    }
+
+    __attribute__((target("avx2"))) static T dot(const T* lhs, const T* rhs, size_t count) {
+        return VectorKernels<T, 32>::dot(lhs, rhs, count);
+    }
+};
+
+#endif
+
+enum class KernelSet {
+    kScalar,
+    kSse2,
+    kAvx2
+};
+
+template<typename T>
+struct NumericKernels {
+    static_assert(std::is_floating_point_v<T>, "NumericKernels are provided for floating point types only");
+
+    KernelSet kernel_set;
+    T (*sum)(const T*, size_t);
+    T (*min)(const T*, size_t);
+    T (*max)(const T*, size_t);
+    T (*squared_deviation)(const T*, size_t, T);
+    T (*dot)(const T*, const T*, size_t);
+
+    template<class Kernels>
+    static NumericKernels make(KernelSet kernel_set_) {
+        return {kernel_set_, &Kernels::sum, &Kernels::min, &Kernels::max, &Kernels::squared_deviation, &Kernels::dot};
+    }
+
+    static bool supported(KernelSet kernel_set_) {
+        switch (kernel_set_) {
+#ifdef CCIRCULAR_BUFFER_X86_KERNELS
+            case KernelSet::kAvx2:
+                return __builtin_cpu_supports("avx2");
+            case KernelSet::kSse2:
+                return __builtin_cpu_supports("sse2");
+#endif
+            case KernelSet::kScalar:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static NumericKernels get(KernelSet kernel_set_) {
+        if (!supported(kernel_set_))
+            throw std::invalid_argument("Error: kernel set is not supported by this CPU");
+
+        switch (kernel_set_) {
+#ifdef CCIRCULAR_BUFFER_X86_KERNELS
+            case KernelSet::kAvx2:
+                return make<Avx2Kernels<T>>(kernel_set_);
+            case KernelSet::kSse2:
+                return make<Sse2Kernels<T>>(kernel_set_);
+#endif
+            default:
+                return make<ScalarKernels<T>>(KernelSet::kScalar);
+        }
+    }
+
+    static const NumericKernels& active() {
+        static const NumericKernels kernels = get(supported(KernelSet::kAvx2) ? KernelSet::kAvx2 :
+                                                  supported(KernelSet::kSse2) ? KernelSet::kSse2 :
+                                                  KernelSet::kScalar);
+
+        return kernels;
+    }
+};
+
+template<class Buffer, typename Result = typename Buffer::value_type>
+using enable_if_numeric_buffer_t =
+    std::enable_if_t<is_circular_buffer<std::remove_cv_t<Buffer>>::value &&
+                     std::is_floating_point_v<typename Buffer::value_type>, Result>;
+
+template<class Buffer>
+enable_if_numeric_buffer_t<Buffer> sum(const Buffer& buffer) {
+    typedef typename Buffer::value_type T;
+    const NumericKernels<T>& kernels = NumericKernels<T>::active();
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+
+    return kernels.sum(one.first, one.second) + kernels.sum(two.first, two.second);
+}
+
+template<class Buffer>
+enable_if_numeric_buffer_t<Buffer> minimum(const Buffer& buffer) {
+    if (buffer.empty())
+        throw std::out_of_range("Empty buffer");
+
+    typedef typename Buffer::value_type T;
+    const NumericKernels<T>& kernels = NumericKernels<T>::active();
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    T result = kernels.min(one.first, one.second);
+    if (two.second != 0) {
+        result = std::min(result, kernels.min(two.first, two.second));
+    }
+
+    return result;
+}
+
+template<class Buffer>
+enable_if_numeric_buffer_t<Buffer> maximum(const Buffer& buffer) {
+    if (buffer.empty())
+        throw std::out_of_range("Empty buffer");
+
+    typedef typename Buffer::value_type T;
+    const NumericKernels<T>& kernels = NumericKernels<T>::active();
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+    T result = kernels.max(one.first, one.second);
+    if (two.second != 0) {
+        result = std::max(result, kernels.max(two.first, two.second));
+    }
+
+    return result;
+}
+
+template<class Buffer>
+enable_if_numeric_buffer_t<Buffer> mean(const Buffer& buffer) {
+    if (buffer.empty())
+        throw std::out_of_range("Empty buffer");
+
+    return sum(buffer) / static_cast<typename Buffer::value_type>(buffer.size());
+}
+
+template<class Buffer>
+enable_if_numeric_buffer_t<Buffer> variance(const Buffer& buffer) {
+    typedef typename Buffer::value_type T;
+    const NumericKernels<T>& kernels = NumericKernels<T>::active();
+    T mean_ = mean(buffer);
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+
+    return (kernels.squared_deviation(one.first, one.second, mean_) +
+            kernels.squared_deviation(two.first, two.second, mean_)) / static_cast<T>(buffer.size());
+}
+
+template<class Buffer>
+enable_if_numeric_buffer_t<Buffer> dot(const Buffer& buffer, const typename Buffer::value_type* coefficients) {
+    typedef typename Buffer::value_type T;
+    const NumericKernels<T>& kernels = NumericKernels<T>::active();
+    auto one = buffer.array_one();
+    auto two = buffer.array_two();
+
+    return kernels.dot(one.first, coefficients, one.second) +
+           kernels.dot(two.first, coefficients + one.second, two.second);
+}
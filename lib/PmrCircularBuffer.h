@@ -0,0 +1,142 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+const size_t kRingPoolSmallestBlock = 64;
+const size_t kRingPoolLargestBlock = 1 << 20;
+const size_t kRingPoolChunkSize = 1 << 16;
+
+namespace pmr {
+
+template<typename T>
+using CCircularBuffer = ::CCircularBuffer<T, std::pmr::polymorphic_allocator<T>>;
+
+template<typename T>
+using CCircularBufferExt = ::CCircularBufferExt<T, std::pmr::polymorphic_allocator<T>>;
+
+template<typename T>
+using CCircularBufferPow2 = ::CCircularBufferPow2<T, std::pmr::polymorphic_allocator<T>>;
+
+template<typename T>
+using CCircularBufferExtPow2 = ::CCircularBufferExtPow2<T, std::pmr::polymorphic_allocator<T>>;
+
+}
+
+// Memory resource for buffer storage churn. Requests are rounded up to power of two size classes
+// (ring storage of CCircularBufferPow2 fits exactly) and released blocks go to a per-class free list,
+// so a buffer created after another one was destroyed reuses its storage without calling upstream.
+// Blocks larger than largest_block or over-aligned requests go straight to upstream.
+// Like std::pmr::unsynchronized_pool_resource, it is not thread safe.
+class RingStoragePool : public std::pmr::memory_resource {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Chunk {
+        void* data;
+        size_t bytes;
+    };
+
+    std::pmr::memory_resource* upstream_;
+    size_t largest_block_;
+    std::vector<FreeBlock*> free_lists;
+    std::vector<Chunk> chunks;
+
+    static size_t size_class(size_t bytes_) {
+        size_t idx_ = 0;
+        for (size_t block = kRingPoolSmallestBlock; block < bytes_; block <<= 1) {
+            idx_++;
+        }
+
+        return idx_;
+    }
+
+    static size_t block_size(size_t idx_) {
+        return kRingPoolSmallestBlock << idx_;
+    }
+
+    bool pooled(size_t bytes_, size_t alignment) const {
+        return bytes_ <= largest_block_ && alignment <= alignof(std::max_align_t);
+    }
+
+    void refill(size_t idx_) {
+        size_t block = block_size(idx_);
+        size_t bytes_ = std::max(block, kRingPoolChunkSize);
+        char* data_ = static_cast<char*>(upstream_->allocate(bytes_, alignof(std::max_align_t)));
+        chunks.push_back({data_, bytes_});
+
+        for (size_t offset = bytes_; offset >= block; offset -= block) {
+            FreeBlock* free_block = reinterpret_cast<FreeBlock*>(data_ + offset - block);
+            free_block->next = free_lists[idx_];
+            free_lists[idx_] = free_block;
+        }
+    }
+protected:
+    void* do_allocate(size_t bytes_, size_t alignment) override {
+        if (!pooled(bytes_, alignment))
+            return upstream_->allocate(bytes_, alignment);
+
+        size_t idx_ = size_class(bytes_);
+        if (free_lists[idx_] == nullptr) {
+            refill(idx_);
+        }
+        FreeBlock* block = free_lists[idx_];
+        free_lists[idx_] = block->next;
+
+        return block;
+    }
+
+    void do_deallocate(void* pointer, size_t bytes_, size_t alignment) override {
+        if (pointer == nullptr) {
+            return;
+        }
+        if (!pooled(bytes_, alignment)) {
+            upstream_->deallocate(pointer, bytes_, alignment);
+            return;
+        }
+
+        size_t idx_ = size_class(bytes_);
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = free_lists[idx_];
+        free_lists[idx_] = block;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override {
+        return this == &rhs;
+    }
+public:
+    explicit RingStoragePool(size_t largest_block = kRingPoolLargestBlock,
+                             std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : upstream_(upstream), largest_block_(largest_block), free_lists(size_class(largest_block) + 1, nullptr) {}
+
+    explicit RingStoragePool(std::pmr::memory_resource* upstream)
+        : RingStoragePool(kRingPoolLargestBlock, upstream) {}
+
+    RingStoragePool(const RingStoragePool&) = delete;
+    RingStoragePool& operator=(const RingStoragePool&) = delete;
+
+    ~RingStoragePool() override {
+        release();
+    }
+
+    void release() {
+        for (const Chunk& chunk : chunks) {
+            upstream_->deallocate(chunk.data, chunk.bytes, alignof(std::max_align_t));
+        }
+        chunks.clear();
+        std::fill(free_lists.begin(), free_lists.end(), nullptr);
+    }
+
+    std::pmr::memory_resource* upstream_resource() const {
+        return upstream_;
+    }
+
+    size_t chunk_count() const {
+        return chunks.size();
+    }
+};
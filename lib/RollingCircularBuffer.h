@@ -0,0 +1,260 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Neumaier's compensated sum. The rounding error of every addition is kept in compensation_, so a long
+// stream of pushes and pops does not accumulate the rounding of the elements that already left the window.
+template<typename T>
+class CompensatedSum {
+public:
+    void add(T value_) {
+        T sum = sum_ + value_;
+        if (std::abs(sum_) >= std::abs(value_)) {
+            compensation_ += (sum_ - sum) + value_;
+        } else {
+            compensation_ += (value_ - sum) + sum_;
+        }
+        sum_ = sum;
+    }
+
+    T value() const {
+        return sum_ + compensation_;
+    }
+private:
+    T sum_ = 0;
+    T compensation_ = 0;
+};
+
+template<typename T>
+class RollingSum {
+public:
+    typedef std::common_type_t<T, double> accumulator_type;
+
+    explicit RollingSum(size_t) {}
+
+    void on_push(const T& element_) {
+        sum_.add(element_);
+    }
+
+    void on_pop(const T& element_) {
+        sum_.add(-static_cast<accumulator_type>(element_));
+    }
+
+    accumulator_type value() const {
+        return sum_.value();
+    }
+private:
+    CompensatedSum<accumulator_type> sum_;
+};
+
+// Sum of squared deviations from the mean of the window. The sums are kept relative to the first element
+// pushed into an empty aggregate, so values sitting far from zero do not cancel each other out.
+template<typename T>
+class RollingSumOfSquares {
+public:
+    typedef std::common_type_t<T, double> accumulator_type;
+
+    explicit RollingSumOfSquares(size_t) {}
+
+    void on_push(const T& element_) {
+        if (count_ == 0) {
+            shift_ = element_;
+            sum_ = CompensatedSum<accumulator_type>();
+            sumsq_ = CompensatedSum<accumulator_type>();
+        }
+        count_++;
+        accumulator_type delta = static_cast<accumulator_type>(element_) - shift_;
+        sum_.add(delta);
+        sumsq_.add(delta * delta);
+    }
+
+    void on_pop(const T& element_) {
+        count_--;
+        accumulator_type delta = static_cast<accumulator_type>(element_) - shift_;
+        sum_.add(-delta);
+        sumsq_.add(-delta * delta);
+    }
+
+    accumulator_type value() const {
+        if (count_ == 0)
+            return 0;
+
+        accumulator_type sum = sum_.value();
+        accumulator_type result = sumsq_.value() - sum * sum / static_cast<accumulator_type>(count_);
+
+        return result < 0 ? 0 : result;
+    }
+private:
+    size_t count_ = 0;
+    accumulator_type shift_ = 0;
+    CompensatedSum<accumulator_type> sum_;
+    CompensatedSum<accumulator_type> sumsq_;
+};
+
+// Monotonic deque of (element, push number) candidates. Every element enters and leaves it at most once,
+// so both updates are amortized O(1) and the current extremum is always at the front.
+template<typename T, class Compare>
+class RollingExtremum {
+public:
+    explicit RollingExtremum(size_t _capacity_) : candidates(_capacity_) {}
+
+    void on_push(const T& element_) {
+        while (!candidates.empty() && !Compare()(candidates.back().first, element_)) {
+            candidates.pop_back();
+        }
+        candidates.push_back(std::make_pair(element_, pushed_++));
+    }
+
+    void on_pop(const T&) {
+        if (candidates.front().second == popped_) {
+            candidates.pop_front();
+        }
+        popped_++;
+    }
+
+    const T& value() const {
+        return candidates.front().first;
+    }
+private:
+    CCircularBuffer<std::pair<T, size_t>> candidates;
+    size_t pushed_ = 0;
+    size_t popped_ = 0;
+};
+
+template<typename T>
+using RollingMin = RollingExtremum<T, std::less<T>>;
+
+template<typename T>
+using RollingMax = RollingExtremum<T, std::greater<T>>;
+
+template<typename T, template<typename> class... Aggregates>
+class RollingCircularBuffer {
+private:
+    CCircularBuffer<T> window_;
+    std::tuple<Aggregates<T>...> aggregates_;
+    size_t capacity_ = 0;
+
+    template<class Aggregate>
+    static constexpr bool has() {
+        return (std::is_same_v<Aggregate, Aggregates<T>> || ...);
+    }
+
+    void evict() {
+        T element_ = window_.pop_front();
+        std::apply([&element_](auto&... aggregate) { (aggregate.on_pop(element_), ...); }, aggregates_);
+    }
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef typename CCircularBuffer<T>::ConstIterator const_iterator;
+    typedef std::common_type_t<T, double> accumulator_type;
+
+    explicit RollingCircularBuffer(size_t _capacity_)
+        : window_(_capacity_), aggregates_(Aggregates<T>(_capacity_)...), capacity_(_capacity_) {
+        if (_capacity_ == 0)
+            throw std::invalid_argument("Error: rolling window must hold at least one element");
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t size() const {
+        return window_.size();
+    }
+
+    bool empty() const {
+        return window_.empty();
+    }
+
+    void clear() {
+        *this = RollingCircularBuffer(capacity_);
+    }
+
+    const T& operator[](size_t idx) const {
+        return window_[idx];
+    }
+
+    const T& front() const {
+        return window_.front();
+    }
+
+    const T& back() const {
+        return window_.back();
+    }
+
+    const_iterator begin() const {
+        return window_.cbegin();
+    }
+
+    const_iterator end() const {
+        return window_.cend();
+    }
+
+    void push_back(const_reference element_) {
+        if (window_.size() == capacity_) {
+            evict();
+        }
+        window_.push_back(element_);
+        std::apply([&element_](auto&... aggregate) { (aggregate.on_push(element_), ...); }, aggregates_);
+    }
+
+    void pop_front() {
+        if (window_.empty())
+            throw std::out_of_range("Empty buffer");
+
+        evict();
+    }
+
+    template<template<typename> class Aggregate>
+    const Aggregate<T>& aggregate() const {
+        return std::get<Aggregate<T>>(aggregates_);
+    }
+
+    accumulator_type sum() const {
+        static_assert(has<RollingSum<T>>(), "sum() requires the RollingSum aggregate");
+
+        return aggregate<RollingSum>().value();
+    }
+
+    accumulator_type mean() const {
+        if (window_.empty())
+            throw std::out_of_range("Empty buffer");
+
+        return sum() / static_cast<accumulator_type>(window_.size());
+    }
+
+    accumulator_type variance() const {
+        static_assert(has<RollingSumOfSquares<T>>(), "variance() requires the RollingSumOfSquares aggregate");
+
+        if (window_.empty())
+            throw std::out_of_range("Empty buffer");
+
+        return aggregate<RollingSumOfSquares>().value() / static_cast<accumulator_type>(window_.size());
+    }
+
+    const T& min() const {
+        static_assert(has<RollingMin<T>>(), "min() requires the RollingMin aggregate");
+        if (window_.empty())
+            throw std::out_of_range("Empty buffer");
+
+        return aggregate<RollingMin>().value();
+    }
+
+    const T& max() const {
+        static_assert(has<RollingMax<T>>(), "max() requires the RollingMax aggregate");
+        if (window_.empty())
+            throw std::out_of_range("Empty buffer");
+
+        return aggregate<RollingMax>().value();
+    }
+};
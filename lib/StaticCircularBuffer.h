@@ -0,0 +1,358 @@
+#pragma once
+
+#include "CCircularBuffer.h"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Ring with compile-time capacity and inline storage. All N slots hold elements (there is no sentinel slot),
+// emptiness and fullness are told apart by size_. Slots outside the live range hold value-initialized
+// or moved-from T, which keeps the type usable in constant expressions.
+template<typename T, size_t N>
+class StaticCircularBuffer {
+    static_assert(N > 0, "StaticCircularBuffer capacity must be positive");
+    static_assert(std::is_default_constructible_v<T>, "StaticCircularBuffer requires default constructible T");
+private:
+    std::array<T, N> elements{};
+    size_t begin_ = 0;
+    size_t size_ = 0;
+
+    static constexpr size_t wrap(size_t idx) {
+        if constexpr ((N & (N - 1)) == 0) {
+            return idx & (N - 1);
+        } else {
+            return idx >= N ? idx - N : idx;
+        }
+    }
+
+    template<bool IsConst>
+    class BasicIterator {
+        friend class StaticCircularBuffer;
+        template<bool> friend class BasicIterator;
+
+        using buffer_pointer = std::conditional_t<IsConst, const StaticCircularBuffer*, StaticCircularBuffer*>;
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+    private:
+        buffer_pointer buffer_ = nullptr;
+        size_t index_ = 0;
+
+        constexpr BasicIterator(buffer_pointer _buffer_, size_t _index_) : buffer_(_buffer_), index_(_index_) {}
+    public:
+        constexpr BasicIterator() = default;
+
+        template<bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        constexpr BasicIterator(const BasicIterator<OtherConst>& rhs) : buffer_(rhs.buffer_), index_(rhs.index_) {}
+
+        constexpr reference operator*() const {
+            return buffer_->elements[wrap(buffer_->begin_ + index_)];
+        }
+
+        constexpr pointer operator->() const {
+            return &**this;
+        }
+
+        constexpr reference operator[](difference_type diff) const {
+            return *(*this + diff);
+        }
+
+        constexpr BasicIterator& operator++() {
+            ++index_;
+
+            return *this;
+        }
+
+        constexpr BasicIterator operator++(int) {
+            BasicIterator res = *this;
+            ++index_;
+
+            return res;
+        }
+
+        constexpr BasicIterator& operator--() {
+            --index_;
+
+            return *this;
+        }
+
+        constexpr BasicIterator operator--(int) {
+            BasicIterator res = *this;
+            --index_;
+
+            return res;
+        }
+
+        constexpr BasicIterator& operator+=(difference_type diff) {
+            index_ += diff;
+
+            return *this;
+        }
+
+        constexpr BasicIterator& operator-=(difference_type diff) {
+            index_ -= diff;
+
+            return *this;
+        }
+
+        constexpr BasicIterator operator+(difference_type diff) const {
+            return BasicIterator(buffer_, index_ + diff);
+        }
+
+        friend constexpr BasicIterator operator+(difference_type diff, const BasicIterator& it) {
+            return it + diff;
+        }
+
+        constexpr BasicIterator operator-(difference_type diff) const {
+            return BasicIterator(buffer_, index_ - diff);
+        }
+
+        constexpr difference_type operator-(const BasicIterator& rhs) const {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        constexpr bool operator==(const BasicIterator& rhs) const {
+            return index_ == rhs.index_;
+        }
+
+        constexpr bool operator!=(const BasicIterator& rhs) const {
+            return index_ != rhs.index_;
+        }
+
+        constexpr bool operator<(const BasicIterator& rhs) const {
+            return index_ < rhs.index_;
+        }
+
+        constexpr bool operator>(const BasicIterator& rhs) const {
+            return index_ > rhs.index_;
+        }
+
+        constexpr bool operator<=(const BasicIterator& rhs) const {
+            return index_ <= rhs.index_;
+        }
+
+        constexpr bool operator>=(const BasicIterator& rhs) const {
+            return index_ >= rhs.index_;
+        }
+    };
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+    typedef std::pair<T*, size_t> array_range;
+    typedef std::pair<const T*, size_t> const_array_range;
+
+    typedef BasicIterator<false>                    Iterator;
+    typedef BasicIterator<true>                     ConstIterator;
+    typedef Iterator                                iterator;
+    typedef ConstIterator                           const_iterator;
+    typedef std::reverse_iterator<Iterator>         reverse_iterator;
+    typedef std::reverse_iterator<ConstIterator>    const_reverse_iterator;
+
+    constexpr StaticCircularBuffer() = default;
+
+    constexpr StaticCircularBuffer(std::initializer_list<T> list) {
+        for (const T& element_ : list) {
+            push_back(element_);
+        }
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    constexpr size_t size() const {
+        return size_;
+    }
+
+    constexpr bool empty() const {
+        return size_ == 0;
+    }
+
+    constexpr bool full() const {
+        return size_ == N;
+    }
+
+    constexpr void clear() {
+        for (size_t i = 0; i < size_; ++i) {
+            elements[wrap(begin_ + i)] = T();
+        }
+        begin_ = 0;
+        size_ = 0;
+    }
+
+    constexpr T& operator[](size_t idx) {
+        if (idx >= size_)
+            throw std::out_of_range("Error: index is out of range");
+
+        return elements[wrap(begin_ + idx)];
+    }
+
+    constexpr const T& operator[](size_t idx) const {
+        if (idx >= size_)
+            throw std::out_of_range("Error: index is out of range");
+
+        return elements[wrap(begin_ + idx)];
+    }
+
+    constexpr T& front() {
+        return elements[begin_];
+    }
+
+    constexpr const T& front() const {
+        return elements[begin_];
+    }
+
+    constexpr T& back() {
+        return elements[wrap(begin_ + (size_ == 0 ? 0 : size_ - 1))];
+    }
+
+    constexpr const T& back() const {
+        return elements[wrap(begin_ + (size_ == 0 ? 0 : size_ - 1))];
+    }
+
+    template<typename... Args>
+    constexpr T& emplace_back(Args&&... args) {
+        size_t pos = wrap(begin_ + size_);
+        elements[pos] = T(std::forward<Args>(args)...);
+        if (size_ == N) {
+            begin_ = wrap(begin_ + 1);
+        } else {
+            size_++;
+        }
+
+        return elements[pos];
+    }
+
+    template<typename... Args>
+    constexpr T& emplace_front(Args&&... args) {
+        begin_ = wrap(begin_ + N - 1);
+        elements[begin_] = T(std::forward<Args>(args)...);
+        if (size_ != N) {
+            size_++;
+        }
+
+        return elements[begin_];
+    }
+
+    constexpr void push_back(const_reference element_) {
+        emplace_back(element_);
+    }
+
+    constexpr void push_back(T&& element_) {
+        emplace_back(std::move(element_));
+    }
+
+    constexpr void push_front(const_reference element_) {
+        emplace_front(element_);
+    }
+
+    constexpr void push_front(T&& element_) {
+        emplace_front(std::move(element_));
+    }
+
+    constexpr T pop_front() {
+        if (size_ == 0)
+            throw std::out_of_range("Empty buffer");
+
+        T element_ = std::move(elements[begin_]);
+        begin_ = wrap(begin_ + 1);
+        size_--;
+
+        return element_;
+    }
+
+    constexpr T pop_back() {
+        if (size_ == 0)
+            throw std::out_of_range("Empty buffer");
+
+        size_--;
+
+        return std::move(elements[wrap(begin_ + size_)]);
+    }
+
+    constexpr array_range array_one() {
+        return array_range(elements.data() + begin_, std::min(size_, N - begin_));
+    }
+
+    constexpr array_range array_two() {
+        return array_range(elements.data(), size_ - std::min(size_, N - begin_));
+    }
+
+    constexpr const_array_range array_one() const {
+        return const_array_range(elements.data() + begin_, std::min(size_, N - begin_));
+    }
+
+    constexpr const_array_range array_two() const {
+        return const_array_range(elements.data(), size_ - std::min(size_, N - begin_));
+    }
+
+    constexpr Iterator begin() {
+        return Iterator(this, 0);
+    }
+
+    constexpr Iterator end() {
+        return Iterator(this, size_);
+    }
+
+    constexpr ConstIterator begin() const {
+        return ConstIterator(this, 0);
+    }
+
+    constexpr ConstIterator end() const {
+        return ConstIterator(this, size_);
+    }
+
+    constexpr ConstIterator cbegin() const {
+        return begin();
+    }
+
+    constexpr ConstIterator cend() const {
+        return end();
+    }
+
+    constexpr reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
+
+    constexpr reverse_iterator rend() {
+        return reverse_iterator(begin());
+    }
+
+    constexpr const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    constexpr const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    constexpr bool operator==(const StaticCircularBuffer& rhs) const {
+        if (size_ != rhs.size_)
+            return false;
+
+        for (size_t i = 0; i < size_; ++i) {
+            if (!(elements[wrap(begin_ + i)] == rhs.elements[wrap(rhs.begin_ + i)]))
+                return false;
+        }
+
+        return true;
+    }
+
+    constexpr bool operator!=(const StaticCircularBuffer& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+template<typename T, size_t N>
+struct is_circular_buffer<StaticCircularBuffer<T, N>> : std::true_type {};
@@ -1,6 +1,30 @@
+#include "lib/BlockingCircularBuffer.h"
+#include "lib/BroadcastCircularBuffer.h"
+#include "lib/BufferSnapshot.h"
+#include "lib/BufferStats.h"
 #include "lib/CCircularBuffer.h"
+#include "lib/ConcurrentCircularBuffer.h"
+#include "lib/MagicCircularBuffer.h"
+#include "lib/MappedCircularBuffer.h"
+#include "lib/NumericCircularBuffer.h"
+#include "lib/PmrCircularBuffer.h"
+#include "lib/RollingCircularBuffer.h"
+#include "lib/StaticCircularBuffer.h"
 #include <gtest/gtest.h>
 
+#include <csignal>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 TEST(CCircularBufferTestSuit, ConstructorTest) {
     CCircularBuffer<float> a(2);
 
@@ -226,3 +250,1901 @@ TEST(CircularBufferTestSuit, AssignTest2) {
     }
 }
 
+
+
+TEST(CircularBufferPow2TestSuit, CapacityTest) {
+    CCircularBufferPow2<int> a(5);
+    CCircularBufferPow2<int> b(7);
+    CCircularBufferPow2<int> c;
+
+    ASSERT_EQ(a.capacity(), 8);
+    ASSERT_EQ(b.capacity(), 8);
+    ASSERT_EQ(c.capacity(), 128);
+}
+
+TEST(CircularBufferPow2TestSuit, WrapAroundTest) {
+    CCircularBufferPow2<int> a(3);
+    CCircularBuffer<int> b(3);
+
+    for (int i = 0; i < 10; ++i) {
+        a.push_back(i);
+        b.push_back(i);
+    }
+    a.push_front(-1);
+
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_EQ(a.front(), -1);
+    ASSERT_EQ(a[1], 7);
+    ASSERT_EQ(a.back(), 8);
+    ASSERT_EQ(b.front(), 7);
+    ASSERT_EQ(b.back(), 9);
+}
+
+TEST(CircularBufferPow2TestSuit, SortingTest) {
+    CCircularBufferPow2<std::string> a(3);
+    a.push_back("CBA");
+    a.push_back("ABC");
+    a.push_back("BAC");
+    a.push_back("AAA");
+
+    std::sort(a.begin(), a.end());
+
+    std::string sorted_a[3] = {"AAA", "ABC", "BAC"};
+
+    for (size_t i = 0; i < a.size(); i++) {
+        ASSERT_EQ(a[i], sorted_a[i]);
+    }
+}
+
+TEST(CircularBufferPow2TestSuit, ExtGrowthTest) {
+    CCircularBufferExtPow2<int> a(3);
+    for (int i = 0; i < 4; ++i) {
+        a.push_back(i);
+    }
+
+    ASSERT_EQ(a.capacity(), 7);
+    ASSERT_EQ(a.size(), 4);
+    ASSERT_EQ(a.back(), 3);
+}
+
+TEST(CircularBufferPow2TestSuit, SmallGrowthFactorTest) {
+    CCircularBufferExtPow2<int> a;
+    a.set_growth_factor(1.2);
+    for (int i = 0; i < 20; ++i) {
+        a.push_back(i);
+        a.push_front(-i);
+    }
+
+    ASSERT_EQ(a.size(), 40);
+    ASSERT_EQ(a.capacity(), 63);
+    ASSERT_EQ(a.front(), -19);
+    ASSERT_EQ(a.back(), 19);
+}
+
+TEST(CircularBufferMoveTestSuit, MoveConstructorTest) {
+    CCircularBuffer<std::string> a = {"move", "me"};
+    CCircularBuffer<std::string> b(std::move(a));
+
+    ASSERT_EQ(b.size(), 2);
+    ASSERT_EQ(b.front(), "move");
+    ASSERT_EQ(b.back(), "me");
+    ASSERT_EQ(a.size(), 0);
+}
+
+TEST(CircularBufferMoveTestSuit, MoveAssignmentTest) {
+    CCircularBufferExt<std::string> a = {"move", "me"};
+    CCircularBufferExt<std::string> b = {"old"};
+    b = std::move(a);
+
+    ASSERT_EQ(b.size(), 2);
+    ASSERT_EQ(b.front(), "move");
+    ASSERT_EQ(b.back(), "me");
+}
+
+TEST(CircularBufferMoveTestSuit, UseAfterMoveTest) {
+    CCircularBuffer<std::string> a(3);
+    a.push_back("x");
+    CCircularBuffer<std::string> b(std::move(a));
+
+    ASSERT_EQ(a.capacity(), b.capacity());
+    ASSERT_TRUE(a.empty());
+    ASSERT_EQ(a.begin(), a.end());
+    a.consume(0);
+    for (int i = 0; i < 5; ++i) {
+        a.push_back(std::to_string(i));
+    }
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_EQ(a.front(), "2");
+
+    CCircularBuffer<int> c(4);
+    CCircularBuffer<int> d(std::move(c));
+    int values[] = {1, 2, 3, 4, 5};
+    c.push_back_n(values, 5);
+    ASSERT_EQ(c.front(), 2);
+    CCircularBuffer<int> e(std::move(c));
+    c.insert(c.begin(), 2, 7);
+    ASSERT_EQ(c.size(), 2);
+    CCircularBuffer<int> f(std::move(c));
+    c.assign({8, 9});
+    ASSERT_EQ(c.back(), 9);
+    CCircularBuffer<int> g(std::move(c));
+    CCircularBuffer<int> copy(c);
+    copy.push_front(1);
+    c.reserve(8);
+    c.push_back(1);
+    ASSERT_EQ(c.size(), 1);
+
+    CCircularBufferExt<std::string> h = {"a", "b"};
+    CCircularBufferExt<std::string> k(std::move(h));
+    h.erase(h.begin(), h.end());
+    h.push_back("c");
+    ASSERT_EQ(h.size(), 1);
+    ASSERT_EQ(h.front(), "c");
+}
+
+TEST(CircularBufferMoveTestSuit, EmplaceTest) {
+    CCircularBuffer<std::pair<int, std::string>> a(3);
+    a.emplace_back(1, "one");
+    a.emplace_front(0, "zero");
+
+    ASSERT_EQ(a.front().second, "zero");
+    ASSERT_EQ(a.back().first, 1);
+
+    CCircularBufferExt<std::string> b;
+    b.emplace_back(3, 'a');
+    b.emplace_back("bb");
+    b.emplace_front("c");
+
+    ASSERT_EQ(b.size(), 3);
+    ASSERT_EQ(b[0], "c");
+    ASSERT_EQ(b[1], "aaa");
+    ASSERT_EQ(b[2], "bb");
+}
+
+TEST(CircularBufferMoveTestSuit, PushRvalueAndPopTest) {
+    CCircularBuffer<std::string> a(2);
+    std::string payload(64, 'x');
+    a.push_back(std::move(payload));
+    a.push_back("tail");
+
+    std::string popped = a.pop_front();
+
+    ASSERT_EQ(popped, std::string(64, 'x'));
+    ASSERT_EQ(a.size(), 1);
+    ASSERT_EQ(a.pop_back(), "tail");
+}
+
+TEST(CircularBufferMoveTestSuit, MoveOnlyTypeTest) {
+    CCircularBufferExt<std::unique_ptr<int>> a(1);
+    a.push_back(std::make_unique<int>(1));
+    a.emplace_back(new int(2));
+
+    std::unique_ptr<int> first = a.pop_front();
+
+    ASSERT_EQ(*first, 1);
+    ASSERT_EQ(*a.front(), 2);
+}
+
+TEST(SpscCircularBufferTestSuit, PushPopTest) {
+    SpscCircularBuffer<std::string> a(2);
+    std::string value;
+
+    ASSERT_TRUE(a.empty());
+    ASSERT_FALSE(a.try_pop(value));
+    ASSERT_TRUE(a.try_push("first"));
+    ASSERT_TRUE(a.try_push(std::string("second")));
+    ASSERT_FALSE(a.try_push("third"));
+    ASSERT_EQ(a.size(), 2);
+
+    ASSERT_TRUE(a.try_pop(value));
+    ASSERT_EQ(value, "first");
+    ASSERT_TRUE(a.try_emplace(3, 'c'));
+    ASSERT_TRUE(a.try_pop(value));
+    ASSERT_EQ(value, "second");
+    ASSERT_TRUE(a.try_pop(value));
+    ASSERT_EQ(value, "ccc");
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(SpscCircularBufferTestSuit, ProducerConsumerTest) {
+    const int kItems = 100000;
+    SpscCircularBuffer<int, std::allocator<int>, Pow2Indexing> a(63);
+
+    std::thread producer([&a]() {
+        for (int i = 0; i < kItems;) {
+            if (a.try_push(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    int value;
+    while (expected < kItems) {
+        if (a.try_pop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(MpmcCircularBufferTestSuit, PushPopTest) {
+    MpmcCircularBuffer<std::string> a(2);
+    std::string value;
+
+    ASSERT_EQ(a.capacity(), 2);
+    ASSERT_FALSE(a.try_pop(value));
+    ASSERT_TRUE(a.try_push("first"));
+    ASSERT_TRUE(a.try_emplace(3, 's'));
+    ASSERT_FALSE(a.try_push("third"));
+    ASSERT_EQ(a.size(), 2);
+
+    ASSERT_EQ(a.pop(), "first");
+    ASSERT_TRUE(a.try_pop(value));
+    ASSERT_EQ(value, "sss");
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(MpmcCircularBufferTestSuit, SmallCapacityTest) {
+    ASSERT_THROW(MpmcCircularBuffer<int>(0), std::invalid_argument);
+    ASSERT_THROW(MpmcCircularBuffer<int>(1), std::invalid_argument);
+
+    MpmcCircularBuffer<int> a(2);
+    ASSERT_TRUE(a.try_push(1));
+    ASSERT_TRUE(a.try_push(2));
+    ASSERT_FALSE(a.try_push(3));
+
+    int value = 0;
+    ASSERT_TRUE(a.try_pop(value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(a.try_push(3));
+    ASSERT_TRUE(a.try_pop(value));
+    ASSERT_TRUE(a.try_pop(value));
+    ASSERT_EQ(value, 3);
+    ASSERT_FALSE(a.try_pop(value));
+}
+
+TEST(MpmcCircularBufferTestSuit, OverwritePolicyTest) {
+    MpmcCircularBuffer<int, std::allocator<int>, Pow2Indexing> a(4, FullPolicy::kOverwrite);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(a.try_push(i));
+    }
+
+    ASSERT_EQ(a.size(), 4);
+    for (int i = 6; i < 10; ++i) {
+        ASSERT_EQ(a.pop(), i);
+    }
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(MpmcCircularBufferTestSuit, StressTest) {
+    const int kThreads = 4;
+    const int kItems = 20000;
+    MpmcCircularBuffer<int> a(64);
+    std::atomic<long long> sum{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&a]() {
+            for (int i = 1; i <= kItems; ++i) {
+                a.push(i);
+            }
+        });
+        threads.emplace_back([&a, &sum]() {
+            long long local = 0;
+            for (int i = 0; i < kItems; ++i) {
+                local += a.pop();
+            }
+            sum += local;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(sum.load(), static_cast<long long>(kThreads) * kItems * (kItems + 1) / 2);
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(CircularBufferBulkTestSuit, PushPopNTest) {
+    CCircularBuffer<int> a(5);
+    int values[] = {1, 2, 3, 4};
+    a.push_back(0);
+    a.push_back(0);
+    a.pop_front();
+    a.pop_front();
+    a.push_back_n(values, 4);
+
+    ASSERT_EQ(a.size(), 4);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(a[i], values[i]);
+    }
+
+    int out[6] = {};
+    ASSERT_EQ(a.pop_front_n(out, 6), 4);
+    ASSERT_TRUE(std::equal(out, out + 4, values));
+    ASSERT_EQ(a.size(), 0);
+}
+
+TEST(CircularBufferBulkTestSuit, PushBackNOverwriteTest) {
+    CCircularBuffer<std::string> a = {"a", "b", "c"};
+    std::string values[] = {"d", "e", "f", "g", "h"};
+
+    a.push_back_n(values, 2);
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_EQ(a[0], "c");
+    ASSERT_EQ(a[1], "d");
+    ASSERT_EQ(a[2], "e");
+
+    a.push_back_n(values, 5);
+    ASSERT_EQ(a[0], "f");
+    ASSERT_EQ(a[1], "g");
+    ASSERT_EQ(a[2], "h");
+}
+
+TEST(CircularBufferBulkTestSuit, ExtPushBackNTest) {
+    CCircularBufferExt<std::string> a(2);
+    std::string values[] = {"a", "b", "c", "d", "e"};
+    a.push_back_n(values, 5);
+
+    ASSERT_EQ(a.size(), 5);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(a[i], values[i]);
+    }
+
+    std::string out[2];
+    ASSERT_EQ(a.pop_front_n(out, 2), 2);
+    ASSERT_EQ(out[0], "a");
+    ASSERT_EQ(out[1], "b");
+    ASSERT_EQ(a.front(), "c");
+}
+
+TEST(CircularBufferBulkTestSuit, ExtWithoutStorageTest) {
+    CCircularBufferExt<int> a;
+    int out[2];
+    ASSERT_EQ(a.pop_front_n(out, 0), 0);
+    ASSERT_EQ(a.pop_front_n(out, 2), 0);
+
+    int values[] = {1, 2, 3};
+    a.push_back_n(values, 3);
+    ASSERT_EQ(a.pop_front_n(out, 2), 2);
+    ASSERT_EQ(out[1], 2);
+}
+
+TEST(CircularBufferViewTestSuit, ArrayOneTwoTest) {
+    CCircularBuffer<int> a(4);
+    for (int i = 0; i < 7; ++i) {
+        a.push_back(i);
+    }
+
+    auto one = a.array_one();
+    auto two = a.array_two();
+    ASSERT_EQ(one.second + two.second, a.size());
+    ASSERT_FALSE(a.is_linearized());
+
+    std::vector<int> joined(one.first, one.first + one.second);
+    joined.insert(joined.end(), two.first, two.first + two.second);
+    ASSERT_EQ(joined, std::vector<int>({3, 4, 5, 6}));
+}
+
+TEST(CircularBufferViewTestSuit, LinearizeTest) {
+    CCircularBuffer<std::string> a(5);
+    for (int i = 0; i < 8; ++i) {
+        a.push_back(std::to_string(i));
+    }
+
+    std::string* data = a.linearize();
+
+    ASSERT_TRUE(a.is_linearized());
+    ASSERT_EQ(a.array_two().second, 0);
+    ASSERT_EQ(a.array_one().second, 5);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(data[i], std::to_string(i + 3));
+        ASSERT_EQ(a[i], std::to_string(i + 3));
+    }
+
+    a.push_back("8");
+    ASSERT_EQ(a.front(), "4");
+    ASSERT_EQ(a.back(), "8");
+}
+
+TEST(CircularBufferViewTestSuit, ExtLinearizeTest) {
+    CCircularBufferExt<int> a(3);
+    a.push_back(1);
+    a.push_back(2);
+    a.pop_front();
+    a.pop_front();
+    a.push_back(3);
+    a.push_back(4);
+    a.push_back(5);
+
+    int* data = a.linearize();
+    ASSERT_EQ(data[0], 3);
+    ASSERT_EQ(data[1], 4);
+    ASSERT_EQ(data[2], 5);
+}
+
+TEST(CircularBufferReserveCommitTestSuit, PrepareCommitTest) {
+    CCircularBuffer<char> a(6);
+    a.push_back('x');
+    a.push_back('x');
+    a.push_back('x');
+    a.pop_front();
+    a.pop_front();
+    a.pop_front();
+
+    auto writable = a.prepare(10);
+    ASSERT_EQ(writable.first.second + writable.second.second, 6);
+    const char* text = "abcdef";
+    std::memcpy(writable.first.first, text, writable.first.second);
+    std::memcpy(writable.second.first, text + writable.first.second, writable.second.second);
+    a.commit(5);
+
+    ASSERT_EQ(a.size(), 5);
+    ASSERT_EQ(a.front(), 'a');
+    ASSERT_EQ(a.back(), 'e');
+    ASSERT_THROW(a.commit(2), std::out_of_range);
+}
+
+TEST(CircularBufferReserveCommitTestSuit, PeekConsumeTest) {
+    CCircularBuffer<int> a(4);
+    for (int i = 0; i < 6; ++i) {
+        a.push_back(i);
+    }
+
+    auto readable = a.peek(3);
+    std::vector<int> seen(readable.first.first, readable.first.first + readable.first.second);
+    seen.insert(seen.end(), readable.second.first, readable.second.first + readable.second.second);
+    ASSERT_EQ(seen, std::vector<int>({2, 3, 4}));
+
+    a.consume(3);
+    ASSERT_EQ(a.size(), 1);
+    ASSERT_EQ(a.front(), 5);
+    ASSERT_THROW(a.consume(2), std::out_of_range);
+}
+
+TEST(CircularBufferReserveCommitTestSuit, ExtConsumeWithoutStorageTest) {
+    CCircularBufferExt<int> a;
+    a.consume(0);
+    ASSERT_TRUE(a.empty());
+    ASSERT_THROW(a.consume(1), std::out_of_range);
+    ASSERT_EQ(a.peek(4).first.second, 0);
+}
+
+TEST(CircularBufferReserveCommitTestSuit, ExtPrepareGrowsTest) {
+    CCircularBufferExt<int> a(2);
+    auto writable = a.prepare(5);
+
+    ASSERT_EQ(writable.first.second + writable.second.second, 5);
+    for (size_t i = 0; i < writable.first.second; ++i) {
+        writable.first.first[i] = static_cast<int>(i);
+    }
+    a.commit(writable.first.second);
+
+    ASSERT_EQ(a.size(), 5);
+    ASSERT_EQ(a.back(), 4);
+}
+
+#ifdef __linux__
+TEST(MagicCircularBufferTestSuit, DoubleMappingTest) {
+    MagicCircularBuffer<char> a(1);
+    size_t capacity = a.capacity();
+
+    ASSERT_GE(capacity, 4096);
+    for (size_t i = 0; i < capacity - 2; ++i) {
+        a.push_back('x');
+    }
+    a.consume(capacity - 2);
+
+    const char text[] = "wrapped";
+    a.push_back_n(text, 7);
+
+    ASSERT_EQ(a.size(), 7);
+    ASSERT_EQ(std::string(a.begin(), a.end()), "wrapped");
+    ASSERT_EQ(std::string(a.peek(7).first, 7), "wrapped");
+}
+
+TEST(MagicCircularBufferTestSuit, OverwriteTest) {
+    MagicCircularBuffer<uint8_t> a(1);
+    for (size_t i = 0; i < a.capacity() + 3; ++i) {
+        a.push_back(static_cast<uint8_t>(i));
+    }
+
+    ASSERT_EQ(a.size(), a.capacity());
+    ASSERT_EQ(a.front(), 3);
+    ASSERT_EQ(a.pop_front(), 3);
+    ASSERT_EQ(a.back(), static_cast<uint8_t>(a.capacity() + 2));
+}
+
+TEST(MagicCircularBufferTestSuit, RotatedBatchTest) {
+    MagicCircularBuffer<uint8_t> a(1);
+    size_t capacity = a.capacity();
+    for (size_t i = 0; i < capacity + 1; ++i) {
+        a.push_back(static_cast<uint8_t>(i));
+    }
+    ASSERT_EQ(a.front(), 1);
+
+    std::vector<uint8_t> batch(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        batch[i] = static_cast<uint8_t>(i * 7);
+    }
+    a.push_back_n(batch.data(), batch.size());
+    ASSERT_EQ(a.size(), capacity);
+    ASSERT_TRUE(std::equal(a.begin(), a.end(), batch.begin()));
+
+    a.push_back_n(batch.data(), 3);
+    ASSERT_EQ(a.size(), capacity);
+    ASSERT_EQ(a.front(), batch[3]);
+    ASSERT_EQ(a.back(), batch[2]);
+}
+
+TEST(MagicCircularBufferTestSuit, PrepareCommitTest) {
+    MagicCircularBuffer<int> a(1024);
+    for (size_t i = 0; i < a.capacity() - 1; ++i) {
+        a.push_back(0);
+    }
+    a.consume(a.capacity() - 1);
+
+    auto writable = a.prepare(4);
+    ASSERT_EQ(writable.second, 4);
+    for (int i = 0; i < 4; ++i) {
+        writable.first[i] = i + 1;
+    }
+    a.commit(4);
+
+    int out[4];
+    ASSERT_EQ(a.pop_front_n(out, 4), 4);
+    ASSERT_EQ(out[0], 1);
+    ASSERT_EQ(out[3], 4);
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(MappedCircularBufferTestSuit, ReattachTest) {
+    std::string path = testing::TempDir() + "mapped_reattach.journal";
+    unlink(path.c_str());
+    {
+        MappedCircularBuffer<int> a(path, 8, 3);
+        for (int i = 1; i <= 11; ++i) {
+            a.push_back(i);
+        }
+        ASSERT_EQ(a.pop_front(), 4);
+        a.sync();
+    }
+
+    MappedCircularBuffer<int> a(path, 8);
+    ASSERT_EQ(a.size(), 7);
+    ASSERT_EQ(a.pushed(), 11);
+    ASSERT_EQ(a.front(), 5);
+    ASSERT_EQ(a.back(), 11);
+    ASSERT_EQ(a.array_one().second + a.array_two().second, 7);
+
+    int batch[10] = {12, 13, 14, 15, 16, 17, 18, 19, 20, 21};
+    a.push_back_n(batch, 10);
+    int out[8];
+    ASSERT_EQ(a.pop_front_n(out, 8), 8);
+    ASSERT_EQ(out[0], 14);
+    ASSERT_EQ(out[7], 21);
+    ASSERT_TRUE(a.empty());
+    unlink(path.c_str());
+}
+
+TEST(MappedCircularBufferTestSuit, CrashTest) {
+    std::string path = testing::TempDir() + "mapped_crash.journal";
+    unlink(path.c_str());
+
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if (child == 0) {
+        MappedCircularBuffer<uint64_t> a(path, 100);
+        for (uint64_t i = 0; i < 250; ++i) {
+            a.push_back(i);
+        }
+        uint64_t batch[30];
+        std::iota(batch, batch + 30, 250);
+        a.push_back_n(batch, 30);
+        a.consume(5);
+        raise(SIGKILL);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFSIGNALED(status));
+
+    MappedCircularBuffer<uint64_t> a(path, 100);
+    ASSERT_EQ(a.size(), 95);
+    ASSERT_EQ(a.pushed(), 280);
+    for (size_t i = 0; i < a.size(); ++i) {
+        ASSERT_EQ(a[i], 185 + i);
+    }
+    unlink(path.c_str());
+}
+
+TEST(MappedCircularBufferTestSuit, FormatTest) {
+    std::string path = testing::TempDir() + "mapped_format.journal";
+    unlink(path.c_str());
+    {
+        MappedCircularBuffer<int> a(path, 16);
+        a.push_back(1);
+    }
+    ASSERT_THROW((MappedCircularBuffer<int>(path, 32)), std::invalid_argument);
+    ASSERT_THROW((MappedCircularBuffer<int64_t>(path, 8)), std::invalid_argument);
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << std::string(kMappedHeaderSize + 16 * sizeof(int), 'x');
+    ASSERT_THROW((MappedCircularBuffer<int>(path, 16)), std::invalid_argument);
+    ASSERT_THROW((MappedCircularBuffer<int>(path, 0)), std::invalid_argument);
+    unlink(path.c_str());
+}
+#endif
+
+TEST(CircularBufferExtGrowthTestSuit, WrappedGrowthKeepsOrderTest) {
+    CCircularBufferExt<std::string> a(4);
+    CCircularBufferExt<int> b(4);
+    for (int i = 0; i < 3; ++i) {
+        a.push_back(std::to_string(i));
+        b.push_back(i);
+    }
+    a.pop_front();
+    a.pop_front();
+    b.pop_front();
+    b.pop_front();
+    for (int i = 3; i < 12; ++i) {
+        a.push_back(std::to_string(i));
+        b.push_back(i);
+    }
+    a.push_front("1");
+    b.push_front(1);
+
+    ASSERT_EQ(a.size(), 11);
+    ASSERT_EQ(b.size(), 11);
+    for (int i = 0; i < 11; ++i) {
+        ASSERT_EQ(a[i], std::to_string(i + 1));
+        ASSERT_EQ(b[i], i + 1);
+    }
+}
+
+TEST(CircularBufferExtGrowthTestSuit, GrowthFactorTest) {
+    CCircularBufferExt<int> a(9);
+    a.set_growth_factor(1.5);
+    for (int i = 0; i < 10; ++i) {
+        a.push_back(i);
+    }
+
+    ASSERT_EQ(a.capacity(), 15);
+    ASSERT_EQ(a.back(), 9);
+    ASSERT_THROW(a.set_growth_factor(1.0), std::invalid_argument);
+}
+
+TEST(CircularBufferExtGrowthTestSuit, DefaultConstructedGrowthTest) {
+    CCircularBufferExt<std::string> a;
+    for (int i = 0; i < 100; ++i) {
+        a.push_back(std::to_string(i));
+    }
+
+    ASSERT_EQ(a.size(), 100);
+    ASSERT_EQ(a.front(), "0");
+    ASSERT_EQ(a.back(), "99");
+}
+
+TEST(CircularBufferExtGrowthTestSuit, ReallocAllocatorTest) {
+    typedef CCircularBufferExt<int, ReallocAllocator<int>> Buffer;
+    Buffer a(4);
+    Buffer b(8);
+    for (int i = 0; i < 4; ++i) {
+        a.push_back(i);
+    }
+    for (int i = 0; i < 8; ++i) {
+        b.push_back(i);
+    }
+    a.pop_front();
+    a.pop_front();
+    a.push_back(4);
+    a.push_back(5);
+    for (int i = 0; i < 5; ++i) {
+        b.pop_front();
+    }
+    for (int i = 8; i < 13; ++i) {
+        b.push_back(i);
+    }
+    a.push_back(6);
+    b.push_back(13);
+
+    ASSERT_EQ(a, Buffer({2, 3, 4, 5, 6}));
+    ASSERT_EQ(b, Buffer({5, 6, 7, 8, 9, 10, 11, 12, 13}));
+
+    Buffer c;
+    for (int i = 0; i < 100; ++i) {
+        c.push_back(i);
+    }
+    ASSERT_EQ(c.front(), 0);
+    ASSERT_EQ(c.back(), 99);
+}
+
+TEST(CircularBufferExtGrowthTestSuit, EraseDoesNotGrowTest) {
+    CCircularBufferExt<int> a = {1, 2, 3, 4};
+    a.erase(1);
+
+    ASSERT_EQ(a.capacity(), 4);
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_EQ(a[0], 1);
+    ASSERT_EQ(a[1], 3);
+    ASSERT_EQ(a[2], 4);
+}
+
+TEST(CircularBufferIteratorTestSuit, WrappedSortTest) {
+    CCircularBuffer<int> a(6);
+    int values[] = {9, 3, 7, 1, 8, 2, 6, 4, 5};
+    for (int value : values) {
+        a.push_back(value);
+    }
+
+    std::sort(a.begin(), a.end());
+
+    ASSERT_TRUE(std::is_sorted(a.begin(), a.end()));
+    ASSERT_EQ(a.front(), 1);
+    ASSERT_EQ(a.back(), 8);
+    ASSERT_EQ(*std::lower_bound(a.begin(), a.end(), 5), 5);
+}
+
+TEST(CircularBufferIteratorTestSuit, ReverseAndConstTest) {
+    CCircularBuffer<std::string> a(3);
+    a.push_back("a");
+    a.push_back("b");
+    a.push_back("c");
+    a.push_back("d");
+
+    std::string reversed;
+    for (auto i = a.rbegin(); i != a.rend(); ++i) {
+        reversed += *i;
+    }
+    ASSERT_EQ(reversed, "dcb");
+
+    const CCircularBuffer<std::string>& b = a;
+    std::string forward;
+    for (const auto& value : b) {
+        forward += value;
+    }
+    ASSERT_EQ(forward, "bcd");
+    ASSERT_EQ(b.cend() - b.cbegin(), 3);
+    ASSERT_EQ(b.crbegin()->size(), 1);
+}
+
+TEST(CircularBufferIteratorTestSuit, ArithmeticTest) {
+    CCircularBufferExt<int> a = {0, 1, 2, 3, 4};
+    a.pop_front();
+    a.push_back(5);
+
+    auto i = a.begin();
+    ASSERT_EQ(*(i++), 1);
+    ASSERT_EQ(*i, 2);
+    ASSERT_EQ(*(i--), 2);
+    ASSERT_EQ(*i, 1);
+    ASSERT_EQ(i[4], 5);
+    ASSERT_EQ(*(2 + i), 3);
+    ASSERT_EQ(*(a.end() - 1), 5);
+    ASSERT_TRUE(a.begin() <= i);
+    ASSERT_TRUE(a.end() >= i + 5);
+    ASSERT_TRUE(i + 5 == a.end());
+
+    CCircularBufferExt<int>::const_iterator c = i;
+    ASSERT_EQ(*c, 1);
+}
+
+TEST(CircularBufferAlgorithmTestSuit, SegmentedAlgorithmsTest) {
+    CCircularBuffer<int> a(5);
+    for (int i = 0; i < 8; ++i) {
+        a.push_back(i);
+    }
+
+    ASSERT_EQ(accumulate(a, 0), 3 + 4 + 5 + 6 + 7);
+    ASSERT_EQ(accumulate(a, 1, std::multiplies<int>()), 3 * 4 * 5 * 6 * 7);
+    ASSERT_EQ(*find(a, 6), 6);
+    ASSERT_EQ(find(a, 6) - a.begin(), 3);
+    ASSERT_TRUE(find(a, 42) == a.end());
+
+    std::vector<int> copied;
+    copy(a, std::back_inserter(copied));
+    ASSERT_EQ(copied, std::vector<int>({3, 4, 5, 6, 7}));
+
+    int sum = 0;
+    for_each(a, [&sum](int value) { sum += value; });
+    ASSERT_EQ(sum, 25);
+
+    std::vector<int> doubled;
+    transform(a, std::back_inserter(doubled), [](int value) { return 2 * value; });
+    ASSERT_EQ(doubled, std::vector<int>({6, 8, 10, 12, 14}));
+
+    transform(a, [](int value) { return value + 1; });
+    ASSERT_EQ(a.front(), 4);
+    ASSERT_EQ(a.back(), 8);
+
+    fill(a, 9);
+    ASSERT_EQ(accumulate(a, 0), 45);
+}
+
+TEST(CircularBufferAlgorithmTestSuit, EqualTest) {
+    CCircularBuffer<std::string> a(3);
+    CCircularBufferExt<std::string> b = {"b", "c", "d"};
+    for (std::string value : {"a", "b", "c", "d"}) {
+        a.push_back(value);
+    }
+    CCircularBuffer<std::string> c = {"b", "c", "d"};
+
+    ASSERT_TRUE(equal(a, b));
+    ASSERT_TRUE(a == c);
+    c.pop_back();
+    ASSERT_FALSE(a == c);
+    c.push_back("e");
+    ASSERT_TRUE(a != c);
+}
+
+TEST(NumericTestSuit, ReductionTest) {
+    CCircularBuffer<double> a(37);
+    for (int i = 0; i < 50; ++i) {
+        a.push_back(i % 2 == 0 ? i : -i);
+    }
+    std::vector<double> values(a.begin(), a.end());
+    ASSERT_FALSE(a.is_linearized());
+
+    double expected_sum = std::accumulate(values.begin(), values.end(), 0.0);
+    double expected_mean = expected_sum / values.size();
+    double expected_variance = 0;
+    for (double value : values) {
+        expected_variance += (value - expected_mean) * (value - expected_mean);
+    }
+    expected_variance /= values.size();
+
+    ASSERT_DOUBLE_EQ(sum(a), expected_sum);
+    ASSERT_DOUBLE_EQ(mean(a), expected_mean);
+    ASSERT_DOUBLE_EQ(variance(a), expected_variance);
+    ASSERT_EQ(minimum(a), *std::min_element(values.begin(), values.end()));
+    ASSERT_EQ(maximum(a), *std::max_element(values.begin(), values.end()));
+
+    std::vector<double> coefficients(values.size());
+    for (size_t i = 0; i < coefficients.size(); ++i) {
+        coefficients[i] = 1.0 / (i + 1);
+    }
+    ASSERT_DOUBLE_EQ(dot(a, coefficients.data()),
+                     std::inner_product(values.begin(), values.end(), coefficients.begin(), 0.0));
+}
+
+TEST(NumericTestSuit, EmptyTest) {
+    CCircularBufferExt<float> a;
+
+    ASSERT_EQ(sum(a), 0.0f);
+    ASSERT_THROW(minimum(a), std::out_of_range);
+    ASSERT_THROW(maximum(a), std::out_of_range);
+    ASSERT_THROW(mean(a), std::out_of_range);
+}
+
+TEST(NumericTestSuit, KernelSetsTest) {
+    std::vector<float> lhs;
+    std::vector<float> rhs;
+    for (int i = 0; i < 103; ++i) {
+        lhs.push_back(static_cast<float>((i * 37) % 101) - 50);
+        rhs.push_back(static_cast<float>(i % 7) / 4);
+    }
+
+    NumericKernels<float> scalar = NumericKernels<float>::get(KernelSet::kScalar);
+    for (KernelSet kernel_set : {KernelSet::kSse2, KernelSet::kAvx2}) {
+        if (!NumericKernels<float>::supported(kernel_set)) {
+            ASSERT_THROW(NumericKernels<float>::get(kernel_set), std::invalid_argument);
+            continue;
+        }
+
+        NumericKernels<float> kernels = NumericKernels<float>::get(kernel_set);
+        for (size_t count : {1, 3, 8, 15, 16, 17, 64, 103}) {
+            ASSERT_FLOAT_EQ(kernels.sum(lhs.data(), count), scalar.sum(lhs.data(), count));
+            ASSERT_EQ(kernels.min(lhs.data(), count), scalar.min(lhs.data(), count));
+            ASSERT_EQ(kernels.max(lhs.data(), count), scalar.max(lhs.data(), count));
+            ASSERT_FLOAT_EQ(kernels.squared_deviation(lhs.data(), count, 1.5f),
+                            scalar.squared_deviation(lhs.data(), count, 1.5f));
+            ASSERT_FLOAT_EQ(kernels.dot(lhs.data(), rhs.data(), count), scalar.dot(lhs.data(), rhs.data(), count));
+        }
+    }
+}
+
+TEST(RollingTestSuit, AggregatesTest) {
+    RollingCircularBuffer<int, RollingSum, RollingSumOfSquares, RollingMin, RollingMax> a(5);
+    std::vector<int> values;
+    for (int i = 0; i < 40; ++i) {
+        int value = (i * 37) % 23 - 11;
+        a.push_back(value);
+        values.push_back(value);
+        if (values.size() > 5) {
+            values.erase(values.begin());
+        }
+
+        double expected_sum = std::accumulate(values.begin(), values.end(), 0.0);
+        double expected_variance = 0;
+        for (int element : values) {
+            expected_variance += (element - expected_sum / values.size()) * (element - expected_sum / values.size());
+        }
+        expected_variance /= values.size();
+
+        ASSERT_EQ(a.size(), values.size());
+        ASSERT_DOUBLE_EQ(a.sum(), expected_sum);
+        ASSERT_DOUBLE_EQ(a.mean(), expected_sum / values.size());
+        ASSERT_NEAR(a.variance(), expected_variance, 1e-9);
+        ASSERT_EQ(a.min(), *std::min_element(values.begin(), values.end()));
+        ASSERT_EQ(a.max(), *std::max_element(values.begin(), values.end()));
+    }
+}
+
+TEST(RollingTestSuit, LargeOffsetVarianceTest) {
+    RollingCircularBuffer<double, RollingSum, RollingSumOfSquares> a(8);
+    std::vector<double> values;
+    for (int i = 0; i < 100000; ++i) {
+        double value = 1e9 + ((i * 37) % 23 - 11) * 0.01;
+        a.push_back(value);
+        values.push_back(value);
+        if (values.size() > 8) {
+            values.erase(values.begin());
+        }
+    }
+
+    double expected_mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    double expected_variance = 0;
+    for (double value : values) {
+        expected_variance += (value - expected_mean) * (value - expected_mean);
+    }
+    expected_variance /= values.size();
+
+    ASSERT_GT(expected_variance, 0.001);
+    ASSERT_NEAR(a.variance(), expected_variance, expected_variance * 1e-4);
+    ASSERT_NEAR(a.mean(), expected_mean, 1e-6);
+
+    while (a.size() > 1) {
+        a.pop_front();
+    }
+    ASSERT_NEAR(a.variance(), 0, 1e-6);
+}
+
+TEST(RollingTestSuit, PopFrontTest) {
+    RollingCircularBuffer<double, RollingMin, RollingMax> a(4);
+    for (double value : {3.0, 1.0, 4.0, 1.0, 5.0}) {
+        a.push_back(value);
+    }
+
+    ASSERT_EQ(a.front(), 1.0);
+    ASSERT_EQ(a.min(), 1.0);
+    ASSERT_EQ(a.max(), 5.0);
+    a.pop_front();
+    a.pop_front();
+    ASSERT_EQ(a.min(), 1.0);
+    a.pop_front();
+    ASSERT_EQ(a.min(), 5.0);
+    a.pop_front();
+    ASSERT_TRUE(a.empty());
+    ASSERT_THROW(a.min(), std::out_of_range);
+    ASSERT_THROW(a.pop_front(), std::out_of_range);
+
+    a.push_back(2.0);
+    a.clear();
+    a.push_back(7.0);
+    ASSERT_EQ(a.min(), 7.0);
+    ASSERT_EQ(a.max(), 7.0);
+}
+
+template<typename T>
+struct TrackingAllocator {
+    typedef T value_type;
+
+    int* allocations;
+
+    explicit TrackingAllocator(int* allocations_) : allocations(allocations_) {}
+
+    template<typename U>
+    TrackingAllocator(const TrackingAllocator<U>& rhs) : allocations(rhs.allocations) {}
+
+    T* allocate(size_t count) {
+        ++*allocations;
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        --*allocations;
+        std::allocator<T>().deallocate(pointer, count);
+    }
+
+    template<typename U>
+    bool operator==(const TrackingAllocator<U>& rhs) const {
+        return allocations == rhs.allocations;
+    }
+
+    template<typename U>
+    bool operator!=(const TrackingAllocator<U>& rhs) const {
+        return allocations != rhs.allocations;
+    }
+};
+
+TEST(AllocatorTestSuit, MinimalAllocatorTest) {
+    int allocations = 0;
+    {
+        CCircularBuffer<std::string, TrackingAllocator<std::string>> a(3, TrackingAllocator<std::string>(&allocations));
+        CCircularBufferExt<std::string, TrackingAllocator<std::string>> b{TrackingAllocator<std::string>(&allocations)};
+        for (std::string value : {"a", "b", "c", "d"}) {
+            a.push_back(value);
+            b.push_back(value);
+        }
+        CCircularBuffer<std::string, TrackingAllocator<std::string>> c(a);
+        ASSERT_EQ(c.get_allocator(), a.get_allocator());
+        ASSERT_EQ(c.front(), "b");
+        ASSERT_EQ(b.size(), 4);
+        ASSERT_GT(allocations, 0);
+
+        MpmcCircularBuffer<int, TrackingAllocator<int>> d(4, FullPolicy::kReject, TrackingAllocator<int>(&allocations));
+        d.push(1);
+        ASSERT_EQ(d.pop(), 1);
+    }
+    ASSERT_EQ(allocations, 0);
+}
+
+TEST(AllocatorTestSuit, PmrTest) {
+    char storage[4096];
+    std::pmr::monotonic_buffer_resource arena(storage, sizeof(storage), std::pmr::null_memory_resource());
+    pmr::CCircularBuffer<std::pmr::string> a(3, &arena);
+    for (const char* value : {"first", "second", "third", "a fairly long string that does not fit into SSO"}) {
+        a.push_back(std::pmr::string(value));
+    }
+
+    ASSERT_EQ(a.get_allocator().resource(), &arena);
+    ASSERT_EQ(a.front().get_allocator().resource(), &arena);
+    ASSERT_EQ(a.back(), "a fairly long string that does not fit into SSO");
+
+    pmr::CCircularBufferExt<int> b(&arena);
+    for (int i = 0; i < 100; ++i) {
+        b.push_back(i);
+    }
+    ASSERT_EQ(b.get_allocator().resource(), &arena);
+
+    pmr::CCircularBufferExt<int> c(&arena);
+    c = b;
+    ASSERT_EQ(c.get_allocator().resource(), &arena);
+    ASSERT_EQ(c.size(), 100);
+    ASSERT_EQ(c.back(), 99);
+}
+
+TEST(AllocatorTestSuit, RingStoragePoolTest) {
+    RingStoragePool pool;
+    for (int connection = 0; connection < 1000; ++connection) {
+        pmr::CCircularBufferPow2<int> a(255, &pool);
+        a.push_back(connection);
+        ASSERT_EQ(a.front(), connection);
+    }
+    ASSERT_EQ(pool.chunk_count(), 1);
+
+    pmr::CCircularBufferPow2<char> large(2 << 20, &pool);
+    large.push_back('x');
+    ASSERT_EQ(pool.chunk_count(), 1);
+}
+
+constexpr int static_ring_sum() {
+    StaticCircularBuffer<int, 4> a;
+    for (int i = 1; i <= 6; ++i) {
+        a.push_back(i);
+    }
+    a.push_front(10);
+    a.pop_back();
+
+    int result = 0;
+    for (int value : a) {
+        result += value;
+    }
+
+    return result;
+}
+
+TEST(StaticTestSuit, ConstexprTest) {
+    static_assert(static_ring_sum() == 10 + 3 + 4);
+    static_assert(StaticCircularBuffer<int, 3>({1, 2, 3, 4}).front() == 2);
+    static_assert(StaticCircularBuffer<char, 16>::capacity() == 16);
+    static_assert(sizeof(StaticCircularBuffer<char, 16>) == 16 + 2 * sizeof(size_t));
+}
+
+TEST(StaticTestSuit, WrapTest) {
+    StaticCircularBuffer<std::string, 3> a;
+    ASSERT_THROW(a.pop_front(), std::out_of_range);
+    for (std::string value : {"a", "b", "c", "d", "e"}) {
+        a.push_back(value);
+    }
+
+    ASSERT_TRUE(a.full());
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_EQ(a[0], "c");
+    ASSERT_EQ(a.back(), "e");
+    ASSERT_THROW(a[3], std::out_of_range);
+    ASSERT_EQ(std::vector<std::string>(a.rbegin(), a.rend()), std::vector<std::string>({"e", "d", "c"}));
+    ASSERT_EQ(a.pop_front(), "c");
+    ASSERT_EQ(a.pop_back(), "e");
+    ASSERT_EQ(a.size(), 1);
+
+    a.clear();
+    ASSERT_TRUE(a.empty());
+    a.push_front("x");
+    ASSERT_EQ(a.front(), "x");
+}
+
+TEST(StaticTestSuit, AlgorithmTest) {
+    StaticCircularBuffer<double, 8> a;
+    for (int i = 0; i < 13; ++i) {
+        a.push_back(i);
+    }
+
+    ASSERT_EQ(a.array_one().second + a.array_two().second, 8);
+    ASSERT_EQ(accumulate(a, 0.0), 5 + 6 + 7 + 8 + 9 + 10 + 11 + 12);
+    ASSERT_DOUBLE_EQ(sum(a), 68);
+    ASSERT_EQ(maximum(a), 12);
+    ASSERT_EQ(*find(a, 9.0), 9);
+    std::sort(a.begin(), a.end(), std::greater<double>());
+    ASSERT_EQ(a.front(), 12);
+    ASSERT_TRUE((a == StaticCircularBuffer<double, 8>({12, 11, 10, 9, 8, 7, 6, 5})));
+}
+
+struct Tracked {
+    static inline int alive = 0;
+
+    std::string value;
+
+    Tracked() {
+        ++alive;
+    }
+
+    Tracked(int value_) : value(std::to_string(value_) + " padded beyond small string optimization") {
+        ++alive;
+    }
+
+    Tracked(const Tracked& rhs) : value(rhs.value) {
+        ++alive;
+    }
+
+    Tracked(Tracked&& rhs) noexcept : value(std::move(rhs.value)) {
+        ++alive;
+    }
+
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) noexcept = default;
+
+    ~Tracked() {
+        --alive;
+    }
+};
+
+TEST(LifetimeTestSuit, OverwriteTest) {
+    {
+        CCircularBuffer<Tracked> a(3);
+        for (int i = 0; i < 10; ++i) {
+            a.push_back(i);
+            ASSERT_EQ(Tracked::alive, a.size());
+            a.push_front(-i);
+            ASSERT_EQ(Tracked::alive, a.size());
+        }
+        ASSERT_EQ(a.front().value.substr(0, 2), "-9");
+
+        a.pop_front();
+        a.pop_back();
+        ASSERT_EQ(Tracked::alive, 1);
+
+        a.insert(Tracked(20), a.begin());
+        a.insert(Tracked(21), a.begin());
+        a.insert(Tracked(22), a.begin() + 1);
+        ASSERT_EQ(Tracked::alive, 3);
+        ASSERT_EQ(a[0].value.substr(0, 2), "21");
+        ASSERT_EQ(a[1].value.substr(0, 2), "22");
+        ASSERT_EQ(a[2].value.substr(0, 2), "20");
+
+        a.erase(a.begin());
+        ASSERT_EQ(Tracked::alive, 2);
+    }
+    ASSERT_EQ(Tracked::alive, 0);
+}
+
+TEST(LifetimeTestSuit, ClearReserveTest) {
+    {
+        CCircularBuffer<Tracked> a(4);
+        CCircularBufferExt<Tracked> b;
+        for (int i = 0; i < 6; ++i) {
+            a.push_back(i);
+            b.push_back(i);
+        }
+
+        size_t capacity_ = a.capacity();
+        a.clear();
+        b.clear();
+        ASSERT_EQ(Tracked::alive, 0);
+        ASSERT_EQ(a.capacity(), capacity_);
+        ASSERT_TRUE(a.empty());
+
+        for (int i = 0; i < 6; ++i) {
+            a.push_back(i);
+            b.push_back(i);
+        }
+        a.reserve(10);
+        b.reserve(100);
+        a.reserve(2);
+        ASSERT_EQ(a.capacity(), 11);
+        ASSERT_EQ(b.capacity(), 100);
+        ASSERT_EQ(Tracked::alive, 4 + 6);
+        ASSERT_EQ(a.front().value.substr(0, 1), "2");
+        ASSERT_EQ(b.back().value.substr(0, 1), "5");
+
+        a = {7, 8};
+        ASSERT_EQ(Tracked::alive, 2 + 6);
+    }
+    ASSERT_EQ(Tracked::alive, 0);
+}
+
+TEST(LifetimeTestSuit, BulkTest) {
+    {
+        std::vector<Tracked> input;
+        for (int i = 0; i < 7; ++i) {
+            input.emplace_back(i);
+        }
+        std::vector<Tracked> output(7);
+        int outside = 14;
+
+        CCircularBuffer<Tracked> a(5);
+        a.push_back(100);
+        a.push_back_n(input.data(), input.size());
+        ASSERT_EQ(Tracked::alive, outside + 5);
+        ASSERT_EQ(a.front().value.substr(0, 1), "2");
+
+        ASSERT_EQ(a.pop_front_n(output.data(), 3), 3);
+        ASSERT_EQ(Tracked::alive, outside + 2);
+        a.consume(1);
+        ASSERT_EQ(Tracked::alive, outside + 1);
+
+        CCircularBufferExt<Tracked> b;
+        b.push_back_n(input.data(), input.size());
+        ASSERT_EQ(b.pop_front_n(output.data(), 2), 2);
+        b.consume(2);
+        ASSERT_EQ(Tracked::alive, outside + 1 + 3);
+    }
+    ASSERT_EQ(Tracked::alive, 0);
+}
+
+template<class Buffer, class Make>
+void check_wrapped_insert_erase(Make make) {
+    Buffer a(7);
+    std::vector<typename Buffer::value_type> model;
+    for (int i = 0; i < 10; ++i) {
+        a.push_back(make(i));
+    }
+    model.assign(a.begin(), a.end());
+    ASSERT_FALSE(a.is_linearized());
+
+    for (size_t idx_ : {0, 2, 5, 6}) {
+        a.insert(make(100 + idx_), a.begin() + idx_);
+        model.insert(model.begin() + idx_, make(100 + idx_));
+        model.resize(std::min<size_t>(model.size(), 7));
+        ASSERT_EQ(std::vector<typename Buffer::value_type>(a.begin(), a.end()), model);
+
+        a.erase(a.begin() + (6 - idx_));
+        model.erase(model.begin() + (6 - idx_));
+        ASSERT_EQ(std::vector<typename Buffer::value_type>(a.begin(), a.end()), model);
+    }
+
+    Buffer copy(a);
+    ASSERT_TRUE(copy == a);
+}
+
+TEST(TrivialPathTestSuit, WrappedInsertEraseTest) {
+    check_wrapped_insert_erase<CCircularBuffer<int>>([](int i) { return i; });
+    check_wrapped_insert_erase<CCircularBuffer<std::string>>([](int i) { return std::to_string(i); });
+    check_wrapped_insert_erase<CCircularBufferPow2<long long>>([](int i) { return static_cast<long long>(i); });
+}
+
+TEST(ShorterSideTestSuit, RangeEraseTest) {
+    CCircularBufferExt<std::string> a;
+    std::vector<std::string> model;
+    for (int i = 0; i < 12; ++i) {
+        a.push_front(std::to_string(i));
+        model.insert(model.begin(), std::to_string(i));
+    }
+
+    for (auto [first, last] : {std::pair<size_t, size_t>{1, 3}, {6, 9}, {0, 0}, {0, 2}, {3, 5}}) {
+        auto next = a.erase(a.begin() + first, a.begin() + last);
+        model.erase(model.begin() + first, model.begin() + last);
+        ASSERT_EQ(std::vector<std::string>(a.begin(), a.end()), model);
+        ASSERT_EQ(next - a.begin(), first);
+    }
+    ASSERT_THROW(a.erase(a.size()), std::out_of_range);
+
+    CCircularBuffer<int> b = {1, 2, 3, 4, 5, 6};
+    b.erase(b.begin() + 1, b.end() - 1);
+    ASSERT_EQ(std::vector<int>(b.begin(), b.end()), std::vector<int>({1, 6}));
+}
+
+TEST(ShorterSideTestSuit, EraseWithoutStorageTest) {
+    CCircularBufferExt<std::string> a;
+    ASSERT_EQ(a.erase(a.begin(), a.end()), a.end());
+    ASSERT_THROW(a.erase(0), std::out_of_range);
+
+    a.push_back("a");
+    a.erase(a.begin(), a.end());
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(ShorterSideTestSuit, MultiInsertTest) {
+    CCircularBufferExt<int> a;
+    std::vector<int> model;
+    for (int i = 0; i < 9; ++i) {
+        a.push_back(i);
+        model.push_back(i);
+    }
+
+    a.insert(a.begin() + 1, 3, -1);
+    model.insert(model.begin() + 1, 3, -1);
+    a.insert(a.end() - 2, 4, -2);
+    model.insert(model.end() - 2, 4, -2);
+    CCircularBufferExt<int> b = {7, 8};
+    a.insert(a.begin() + 3, b);
+    model.insert(model.begin() + 3, {7, 8});
+    ASSERT_EQ(std::vector<int>(a.begin(), a.end()), model);
+
+    CCircularBuffer<std::string> c = {"a", "b", "c", "d"};
+    c.insert(c.begin() + 1, 2, "x");
+    ASSERT_EQ(std::vector<std::string>(c.begin(), c.end()), std::vector<std::string>({"a", "x", "x", "b"}));
+    c.insert("y", c.end());
+    ASSERT_EQ(c.back(), "y");
+    c.insert(c.begin() + 1, 9, "z");
+    ASSERT_EQ(std::vector<std::string>(c.begin(), c.end()), std::vector<std::string>({"z", "z", "z", "z"}));
+}
+
+TEST(BatchedAssignTestSuit, PrefixTest) {
+    CCircularBuffer<int> a(6);
+    for (int i = 0; i < 9; ++i) {
+        a.push_back(i);
+    }
+    ASSERT_FALSE(a.is_linearized());
+
+    std::vector<int> source = {10, 11, 12, 13, 14};
+    a.assign(source.data(), source.data() + 3);
+    ASSERT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({10, 11, 12, 6, 7, 8}));
+
+    a.clear();
+    a.push_back(1);
+    a.assign(source.begin(), source.end());
+    ASSERT_EQ(std::vector<int>(a.begin(), a.end()), source);
+
+    a.assign(9, -1);
+    ASSERT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>(6, -1));
+
+    a.assign({1, 2, 3, 4, 5, 6, 7, 8});
+    ASSERT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({3, 4, 5, 6, 7, 8}));
+
+    std::istringstream stream("20 21 22 23 24 25 26");
+    a.assign(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+    ASSERT_EQ(std::vector<int>(a.begin(), a.end()), std::vector<int>({21, 22, 23, 24, 25, 26}));
+}
+
+TEST(BatchedAssignTestSuit, BufferTest) {
+    CCircularBuffer<std::string> a(4);
+    CCircularBuffer<std::string> b(5);
+    for (int i = 0; i < 7; ++i) {
+        a.push_back(std::to_string(i));
+        b.push_front(std::to_string(10 + i));
+    }
+
+    a.assign(b);
+    ASSERT_EQ(std::vector<std::string>(a.begin(), a.end()), std::vector<std::string>(b.begin() + 1, b.end()));
+
+    CCircularBufferExt<std::string> c = {"x"};
+    CCircularBufferExt<std::string> d = {"a", "b", "c"};
+    c.assign(std::move(d));
+    ASSERT_EQ(std::vector<std::string>(c.begin(), c.end()), std::vector<std::string>({"a", "b", "c"}));
+    ASSERT_TRUE(d.front().empty());
+
+    c.assign(200, "y");
+    ASSERT_EQ(c.size(), 200);
+    ASSERT_EQ(c.back(), "y");
+}
+
+TEST(BatchedAssignTestSuit, EmptySourceWithoutStorageTest) {
+    CCircularBufferExt<int> a = {1, 2, 3};
+    CCircularBufferExt<int> e;
+    a.assign(e);
+    a.assign(CCircularBufferExt<int>());
+    ASSERT_EQ(a, CCircularBufferExt<int>({1, 2, 3}));
+
+    CCircularBufferExt<int> b;
+    b.assign(e);
+    ASSERT_TRUE(b.empty());
+    b.push_back(4);
+    ASSERT_EQ(b.front(), 4);
+}
+
+TEST(BatchedAssignTestSuit, LifetimeTest) {
+    {
+        std::vector<Tracked> input;
+        for (int i = 0; i < 6; ++i) {
+            input.emplace_back(i);
+        }
+
+        CCircularBufferExt<Tracked> a;
+        a.push_back(100);
+        a.push_back(101);
+        a.assign(std::make_move_iterator(input.begin()), std::make_move_iterator(input.end()));
+        ASSERT_EQ(Tracked::alive, 6 + 6);
+        ASSERT_EQ(a.back().value.substr(0, 1), "5");
+        ASSERT_TRUE(input.back().value.empty());
+
+        CCircularBuffer<Tracked> b(3);
+        b.assign(4, Tracked(7));
+        ASSERT_EQ(Tracked::alive, 6 + 6 + 3);
+    }
+    ASSERT_EQ(Tracked::alive, 0);
+}
+
+TEST(BlockingTestSuit, PolicyTest) {
+    BlockingCircularBuffer<int> a(3, FullPolicy::kReject);
+    ASSERT_TRUE(a.push(1));
+    int values[] = {2, 3, 4, 5};
+    ASSERT_EQ(a.push_n(values, 4), 2);
+    ASSERT_FALSE(a.push(6));
+    ASSERT_EQ(a.pop(), 1);
+
+    BlockingCircularBuffer<std::string, std::allocator<std::string>, Pow2Indexing> b(3, FullPolicy::kOverwrite);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(b.push(std::to_string(i)));
+    }
+    ASSERT_EQ(b.size(), 3);
+    ASSERT_EQ(b.pop(), "2");
+
+    BlockingCircularBuffer<int> c(4, FullPolicy::kOverwrite);
+    int more[] = {1, 2, 3, 4, 5, 6};
+    c.push(0);
+    ASSERT_EQ(c.push_n(more, 3), 3);
+    ASSERT_EQ(c.push_n(more, 6), 6);
+    std::vector<int> out;
+    ASSERT_EQ(c.drain_into(std::back_inserter(out), 10), 4);
+    ASSERT_EQ(out, std::vector<int>({3, 4, 5, 6}));
+    ASSERT_TRUE(c.empty());
+}
+
+TEST(BlockingTestSuit, PopForTest) {
+    BlockingCircularBuffer<int> a(2);
+    ASSERT_EQ(a.pop_for(std::chrono::milliseconds(5)), std::nullopt);
+
+    std::thread producer([&a]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        a.push(7);
+    });
+    ASSERT_EQ(a.pop_for(std::chrono::seconds(10)), 7);
+    producer.join();
+}
+
+TEST(BlockingTestSuit, BlockOnFullTest) {
+    BlockingCircularBuffer<int> a(4);
+    int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::thread producer([&a, &values]() {
+        ASSERT_EQ(a.push_n(values, 10), 10);
+        a.push(11);
+    });
+
+    std::vector<int> out;
+    while (out.size() < 11) {
+        if (a.drain_into(std::back_inserter(out), 3) == 0) {
+            out.push_back(a.pop());
+        }
+        ASSERT_LE(a.size(), 4);
+    }
+    producer.join();
+
+    std::vector<int> expected(11);
+    std::iota(expected.begin(), expected.end(), 1);
+    ASSERT_EQ(out, expected);
+}
+
+TEST(BlockingTestSuit, StressTest) {
+    const int kThreads = 4;
+    const int kItems = 20000;
+    BlockingCircularBuffer<int> a(16);
+    std::atomic<long long> sum{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&a]() {
+            for (int i = 1; i <= kItems; i += 4) {
+                int batch[] = {i, i + 1, i + 2, i + 3};
+                a.push_n(batch, 4);
+            }
+        });
+        threads.emplace_back([&a, &sum]() {
+            long long local = 0;
+            for (int i = 0; i < kItems; ++i) {
+                local += a.pop();
+            }
+            sum += local;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(sum.load(), static_cast<long long>(kThreads) * kItems * (kItems + 1) / 2);
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(BroadcastTestSuit, LappedReaderTest) {
+    BroadcastCircularBuffer<int> a(4);
+    auto first = a.reader();
+    auto second = a.reader();
+    for (int i = 1; i <= 3; ++i) {
+        a.push_back(i);
+    }
+
+    int value = 0;
+    std::vector<int> out;
+    while (first.try_read(value)) {
+        out.push_back(value);
+    }
+    ASSERT_EQ(out, std::vector<int>({1, 2, 3}));
+    ASSERT_FALSE(first.lapped());
+
+    int values[] = {4, 5, 6, 7, 8, 9, 10};
+    a.push_back_n(values, 7);
+    ASSERT_TRUE(first.lapped());
+    ASSERT_EQ(first.available(), 4);
+
+    int batch[8] = {};
+    ASSERT_EQ(first.read_n(batch, 8), 4);
+    ASSERT_EQ(std::vector<int>(batch, batch + 4), std::vector<int>({7, 8, 9, 10}));
+    ASSERT_EQ(first.lost(), 3);
+    ASSERT_EQ(first.read_n(batch, 8), 0);
+
+    ASSERT_EQ(second.read_n(batch, 2), 2);
+    ASSERT_EQ(batch[0], 7);
+    ASSERT_EQ(second.lost(), 6);
+    ASSERT_EQ(second.position(), 8);
+    ASSERT_EQ(a.size(), 4);
+    ASSERT_EQ(a.published(), 10);
+}
+
+struct Stamped {
+    uint64_t value;
+    uint64_t check;
+};
+
+TEST(BroadcastTestSuit, ConcurrentReadersTest) {
+    const uint64_t kItems = 200000;
+    BroadcastCircularBuffer<Stamped, std::allocator<Stamped>, Pow2Indexing> a(255);
+    std::vector<BroadcastCircularBuffer<Stamped, std::allocator<Stamped>, Pow2Indexing>::Reader> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.push_back(a.reader());
+    }
+
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (auto& reader : readers) {
+        threads.emplace_back([&reader, &failed, kItems]() {
+            Stamped batch[32];
+            uint64_t seen = 0;
+            uint64_t next = 0;
+            while (next < kItems) {
+                size_t n = reader.read_n(batch, 32);
+                for (size_t i = 0; i < n; ++i) {
+                    if (batch[i].check != ~batch[i].value || batch[i].value < next) {
+                        failed = true;
+                    }
+                    next = batch[i].value + 1;
+                }
+                seen += n;
+                if (seen + reader.lost() != reader.position()) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (uint64_t i = 0; i < kItems; ++i) {
+        a.push_back({i, ~i});
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_FALSE(failed.load());
+    for (auto& reader : readers) {
+        ASSERT_EQ(reader.position(), kItems);
+    }
+}
+
+TEST(StatsTestSuit, CountersTest) {
+    CCircularBuffer<int, std::allocator<int>, ModuloIndexing, BufferStats> a(3);
+    for (int i = 0; i < 5; ++i) {
+        a.push_back(i);
+    }
+    ASSERT_EQ(a.stats().pushes(), 5);
+    ASSERT_EQ(a.stats().overwrites(), 2);
+    ASSERT_EQ(a.stats().peak_size(), 3);
+
+    a.pop_front();
+    int values[10] = {};
+    a.push_back_n(values, 10);
+    a.insert(a.begin(), 5, 1);
+    a.consume(2);
+
+    BufferStats::Snapshot snapshot = a.stats().snapshot();
+    ASSERT_EQ(snapshot.pushes, 11);
+    ASSERT_EQ(snapshot.pops, 3);
+    ASSERT_EQ(snapshot.overwrites, 7);
+    ASSERT_EQ(snapshot.drops, 9);
+    ASSERT_EQ(snapshot.growths, 0);
+
+    CCircularBufferExt<int, std::allocator<int>, ModuloIndexing, BufferStats> b;
+    for (int i = 0; i < 100; ++i) {
+        b.push_front(i);
+    }
+    ASSERT_EQ(b.stats().growths(), 7);
+    ASSERT_EQ(b.stats().overwrites(), 0);
+    ASSERT_EQ(b.stats().peak_size(), 100);
+
+    ASSERT_EQ(sizeof(CCircularBuffer<int>), sizeof(int*) + 5 * sizeof(size_t));
+}
+
+TEST(StatsTestSuit, AssignEraseTest) {
+    CCircularBufferExt<int, std::allocator<int>, ModuloIndexing, BufferStats> a;
+    a.assign({1, 2, 3, 4});
+    a.assign({5, 6});
+    a.erase(a.begin() + 1, a.begin() + 3);
+    a.insert(a.begin(), 3, 7);
+
+    BufferStats::Snapshot snapshot = a.stats().snapshot();
+    ASSERT_EQ(a.size(), 5);
+    ASSERT_EQ(snapshot.pushes, 9);
+    ASSERT_EQ(snapshot.pops, 2);
+    ASSERT_EQ(snapshot.overwrites, 0);
+    ASSERT_EQ(snapshot.peak_size, 5);
+
+    CCircularBuffer<int, std::allocator<int>, ModuloIndexing, BufferStats> b(3);
+    std::vector<int> values = {1, 2, 3, 4, 5};
+    b.assign(values.begin(), values.end());
+    b.erase(b.begin());
+    std::istringstream in("8 9 10");
+    b.assign(std::istream_iterator<int>(in), std::istream_iterator<int>());
+
+    snapshot = b.stats().snapshot();
+    ASSERT_EQ(b.back(), 10);
+    ASSERT_EQ(snapshot.pushes, 6);
+    ASSERT_EQ(snapshot.pops, 1);
+    ASSERT_EQ(snapshot.overwrites, 0);
+    ASSERT_EQ(snapshot.drops, 2);
+    ASSERT_EQ(snapshot.peak_size, 3);
+
+    b.push_back(11);
+    ASSERT_EQ(b.stats().overwrites(), 1);
+    b.assign({1, 2, 3});
+    b.assign(2, 4);
+    ASSERT_EQ(b.stats().overwrites(), 1);
+}
+
+TEST(StatsTestSuit, ConcurrentReadTest) {
+    CCircularBuffer<int, std::allocator<int>, Pow2Indexing, BufferStats> a(63);
+    std::atomic<bool> done{false};
+    std::atomic<bool> failed{false};
+
+    std::thread monitor([&a, &done, &failed]() {
+        uint64_t last = 0;
+        while (!done.load()) {
+            uint64_t pushes = a.stats().pushes();
+            if (pushes < last || a.stats().peak_size() > 63) {
+                failed = true;
+            }
+            last = pushes;
+        }
+    });
+    for (int i = 0; i < 100000; ++i) {
+        a.push_back(i);
+    }
+    done = true;
+    monitor.join();
+
+    ASSERT_FALSE(failed.load());
+    ASSERT_EQ(a.stats().overwrites(), 100000 - 63);
+}
+
+TEST(StatsTestSuit, LatencyTest) {
+    CCircularBuffer<std::string, std::allocator<std::string>, ModuloIndexing, LatencyStats> a(2);
+    for (int i = 0; i < 5; ++i) {
+        a.push_back(std::to_string(i));
+    }
+    a.pop_front();
+    a.pop_back();
+
+    auto histogram = a.stats().latency_histogram();
+    ASSERT_EQ(std::accumulate(histogram.begin(), histogram.end(), uint64_t(0)), 2);
+
+    CCircularBufferExt<int, std::allocator<int>, ModuloIndexing, LatencyStats> b;
+    b.reserve(16);
+    int values[8] = {};
+    b.push_back_n(values, 8);
+    b.push_back(1);
+    int out[9];
+    ASSERT_EQ(b.pop_front_n(out, 9), 9);
+    histogram = b.stats().latency_histogram();
+    ASSERT_EQ(std::accumulate(histogram.begin(), histogram.end(), uint64_t(0)), 9);
+}
+
+TEST(StatsTestSuit, LatencyRelocationTest) {
+    typedef CCircularBuffer<int, std::allocator<int>, ModuloIndexing, LatencyStats> Buffer;
+    auto samples = [](const Buffer& buffer) {
+        auto histogram = buffer.stats().latency_histogram();
+        return std::accumulate(histogram.begin(), histogram.end(), uint64_t(0));
+    };
+
+    Buffer a(4);
+    for (int i = 0; i < 6; ++i) {
+        a.push_back(i);
+    }
+    a.linearize();
+    a.pop_front();
+    ASSERT_EQ(samples(a), 0);
+
+    Buffer b(4);
+    b.push_back(1);
+    a.swap(b);
+    a.pop_front();
+    b.pop_front();
+    ASSERT_EQ(samples(a) + samples(b), 0);
+
+    b.reserve(10);
+    b.pop_front();
+    Buffer c(std::move(b));
+    c.pop_front();
+    ASSERT_EQ(samples(b) + samples(c), 0);
+
+    c.push_back(1);
+    c.pop_front();
+    ASSERT_EQ(samples(c), 1);
+}
+
+TEST(SnapshotTestSuit, RoundTripTest) {
+    CCircularBuffer<int> a(8);
+    for (int i = 1; i <= 11; ++i) {
+        a.push_back(i);
+    }
+    ASSERT_FALSE(a.is_linearized());
+
+    std::stringstream stream;
+    save(a, stream);
+    CCircularBuffer<int> b(2);
+    load(b, stream);
+    ASSERT_EQ(b.capacity(), a.capacity());
+    ASSERT_TRUE(b.is_linearized());
+    ASSERT_EQ(b, a);
+
+    CCircularBufferExtPow2<double> c;
+    std::stringstream empty;
+    save(c, empty);
+    c.push_back(1.5);
+    load(c, empty);
+    ASSERT_TRUE(c.empty());
+
+    for (int i = 0; i < 20; ++i) {
+        c.push_back(i * 0.5);
+    }
+    std::stringstream grown;
+    save(c, grown);
+    CCircularBufferExtPow2<double> d;
+    load(d, grown);
+    ASSERT_EQ(d.capacity(), c.capacity());
+    ASSERT_EQ(d, c);
+}
+
+TEST(SnapshotTestSuit, CodecTest) {
+    CCircularBufferExt<std::string> a;
+    for (int i = 0; i < 10; ++i) {
+        a.push_back(std::string(i * 10, 'a' + i));
+    }
+    a.pop_front();
+
+    std::stringstream stream;
+    save(a, stream);
+    CCircularBufferExt<std::string> b;
+    load(b, stream);
+    ASSERT_EQ(b, a);
+
+    std::string bytes = stream.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 5));
+    ASSERT_THROW(load(b, truncated), std::invalid_argument);
+    ASSERT_EQ(b, a);
+
+    CCircularBufferExt<int> raw;
+    raw.push_back(1);
+    std::stringstream other;
+    save(raw, other);
+    ASSERT_THROW(load(b, other), std::invalid_argument);
+}
+
+TEST(SnapshotTestSuit, CorruptedHeaderTest) {
+    CCircularBuffer<int> a(4);
+    a.push_back(1);
+    std::stringstream stream;
+    save(a, stream);
+    std::string bytes = stream.str();
+    SnapshotHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    CCircularBuffer<int> b(2);
+    b.push_back(7);
+    for (uint64_t capacity : {uint64_t(SIZE_MAX), uint64_t(SIZE_MAX / 2), uint64_t(b.max_size()) + 1}) {
+        header.capacity = capacity;
+        header.size = 0;
+        std::memcpy(&bytes[0], &header, sizeof(header));
+        std::stringstream corrupted(bytes);
+        ASSERT_THROW(load(b, corrupted), std::invalid_argument);
+    }
+
+    header.capacity = 1000000000;
+    header.size = 1000000000;
+    std::memcpy(&bytes[0], &header, sizeof(header));
+    std::stringstream truncated(bytes);
+    ASSERT_THROW(load(b, truncated), std::invalid_argument);
+
+    CCircularBufferExtPow2<int> c;
+    header.capacity = SIZE_MAX;
+    header.size = SIZE_MAX;
+    std::memcpy(&bytes[0], &header, sizeof(header));
+    std::stringstream overflowing(bytes);
+    ASSERT_THROW(load(c, overflowing), std::invalid_argument);
+
+    ASSERT_EQ(b.size(), 1);
+    ASSERT_EQ(b.front(), 7);
+}
+
+TEST(SnapshotTestSuit, ExtWithoutStorageTest) {
+    CCircularBufferExt<int> a;
+    ASSERT_EQ(a.capacity(), 0);
+
+    std::stringstream stream;
+    save(a, stream);
+    CCircularBufferExt<int> b(4);
+    b.push_back(1);
+    load(b, stream);
+    ASSERT_TRUE(b.empty());
+    ASSERT_EQ(b.capacity(), 0);
+
+    b.push_back(2);
+    ASSERT_EQ(b.front(), 2);
+}
+
+#ifdef __linux__
+TEST(SnapshotTestSuit, FileDescriptorTest) {
+    CCircularBufferPow2<uint64_t> a(1000);
+    for (uint64_t i = 0; i < 1500; ++i) {
+        a.push_back(i);
+    }
+
+    std::string path = testing::TempDir() + "buffer.snapshot";
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    ASSERT_NE(fd, -1);
+    save(a, fd);
+    ASSERT_EQ(lseek(fd, 0, SEEK_END), sizeof(SnapshotHeader) + a.size() * sizeof(uint64_t));
+
+    lseek(fd, 0, SEEK_SET);
+    CCircularBufferPow2<uint64_t> b(1);
+    load(b, fd);
+    ASSERT_EQ(b.capacity(), a.capacity());
+    ASSERT_EQ(b, a);
+
+    ASSERT_THROW(load(b, fd), std::invalid_argument);
+
+    SnapshotHeader header;
+    lseek(fd, 0, SEEK_SET);
+    ASSERT_EQ(read(fd, &header, sizeof(header)), sizeof(header));
+    header.capacity = 1ull << 40;
+    header.size = 1ull << 40;
+    lseek(fd, 0, SEEK_SET);
+    ASSERT_EQ(write(fd, &header, sizeof(header)), sizeof(header));
+    lseek(fd, 0, SEEK_SET);
+    ASSERT_THROW(load(b, fd), std::invalid_argument);
+    ASSERT_EQ(b, a);
+    close(fd);
+    unlink(path.c_str());
+}
+#endif
@@ -0,0 +1,41 @@
+// Built as C++20, so that the iterator concept checks in the headers are compiled and every header
+// is checked against C++20 rules (rewritten comparisons, removed implicit conversions).
+#include "lib/BlockingCircularBuffer.h"
+#include "lib/BroadcastCircularBuffer.h"
+#include "lib/BufferSnapshot.h"
+#include "lib/BufferStats.h"
+#include "lib/CCircularBuffer.h"
+#include "lib/ConcurrentCircularBuffer.h"
+#include "lib/MagicCircularBuffer.h"
+#include "lib/MappedCircularBuffer.h"
+#include "lib/NumericCircularBuffer.h"
+#include "lib/PmrCircularBuffer.h"
+#include "lib/RollingCircularBuffer.h"
+#include "lib/StaticCircularBuffer.h"
+
+#include <algorithm>
+#include <functional>
+#include <ranges>
+#include <string>
+
+#ifndef __cpp_lib_concepts
+#error "cxx20_check requires a standard library with concepts"
+#endif
+
+static_assert(std::random_access_iterator<CCircularBuffer<std::string>::iterator>);
+static_assert(std::random_access_iterator<CCircularBufferExt<std::string>::const_iterator>);
+static_assert(std::ranges::random_access_range<CCircularBuffer<int>>);
+static_assert(std::ranges::sized_range<CCircularBufferExt<int>>);
+static_assert(std::ranges::random_access_range<const CCircularBufferPow2<double>>);
+
+int main() {
+    CCircularBuffer<int> a(4);
+    CCircularBufferExt<int> b;
+    for (int i = 0; i < 6; ++i) {
+        a.push_back(i);
+        b.push_back(5 - i);
+    }
+    std::ranges::sort(a, std::greater<>());
+
+    return std::ranges::equal(a, b | std::views::take(4)) ? 0 : 1;
+}